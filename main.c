@@ -1,18 +1,40 @@
 #include <stdio.h>
+#include <stdarg.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdatomic.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
 #include "freertos/event_groups.h"
+#include "freertos/timers.h"
+#include "freertos/message_buffer.h"
+#include "freertos/stream_buffer.h"
 #include "esp_system.h"
 #include "esp_task_wdt.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
+#include "esp_pm.h"
+#include "esp_freertos_hooks.h"
+#include "driver/uart.h"
+#include "driver/gptimer.h"
+#include "esp_private/esp_clk.h"
+#include "esp_rom_crc.h"
+#include "nvs_flash.h"
+#include "nvs.h"
 #include <inttypes.h>
+#include <math.h>
+#include "trace_hooks.h"
 
 /* ========== CONFIGURAÇÕES ========== */
+/* Os parâmetros ajustáveis abaixo são os padrões da tabela de configuração
+ * (cfg_params): valores salvos no NVS os substituem no boot. */
 #define QUEUE_LENGTH            10
-#define QUEUE_ITEM_SIZE         sizeof(int)
+#define QUEUE_ITEM_SIZE         sizeof(data_msg_t)
 #define TWDT_TIMEOUT_S          5
 
 #define GENERATOR_TASK_PRIO     5
@@ -22,14 +44,188 @@
 #define GENERATOR_STACK_SIZE    3072
 #define RECEIVER_STACK_SIZE     4096
 #define SUPERVISOR_STACK_SIZE   3072
+#define TRANSMITTER_STACK_SIZE  3072
+#define TRANSMITTER_TASK_PRIO   3
+
+/* Estágio de transmissão (buffers em rodízio entre receptor e transmissor) */
+#define TX_SINK_CONSOLE         0      // stdout (UART0, compartilhada com os logs)
+#define TX_SINK_UART            1      // UART dedicada via driver
+#define TX_SINK                 TX_SINK_UART
+#define TX_UART_NUM             UART_NUM_1
+#define TX_UART_TX_PIN          17
+#define TX_UART_RX_PIN          16
+#define TX_UART_BAUD            921600
+#define TX_UART_BUF_SIZE        2048   // Ring buffer de TX do driver UART
+#define TX_NUM_BUFFERS          2      // 2 = double buffering
+#define TX_BATCH_SIZE           16     // Valores por lote
+#define TX_FLUSH_MS             1000   // Idade máxima de um lote parcial
+#define TX_LINE_MAX             72     // Bytes máximos por valor no modo texto
+
+/* Integridade das mensagens (CRC32 do gerador ao receptor) */
+#define CRC_IMPL_BYTEWISE       0      // Tabela de 256 entradas, 1 byte por passo
+#define CRC_IMPL_SLICE8         1      // Slicing-by-8: 8 tabelas, 8 bytes por passo
+#define CRC_IMPL_ROM            2      // esp_rom_crc32_le() da ROM do chip
+#define CRC_IMPL                CRC_IMPL_SLICE8
+#define CRC_BENCHMARK_ENABLED   0      // Mede a vazão de cada implementação no boot
+
+/* Gravação e replay do fluxo do gerador */
+#define REPLAY_MODE_OFF         0
+#define REPLAY_MODE_RECORD      1      // Grava valores e intervalos e despeja no console
+#define REPLAY_MODE_REPLAY      2      // Alimenta o receptor a partir de replay_stream.h
+#define REPLAY_MODE             REPLAY_MODE_OFF
+#define REPLAY_SPEED_RECORDED   0      // Respeita os intervalos gravados
+#define REPLAY_SPEED_MAX        1      // O mais rápido que o receptor aceitar
+#define REPLAY_SPEED            REPLAY_SPEED_MAX
+#define REPLAY_MAX_SAMPLES      1024   // Amostras gravadas por despejo
+#define REPLAY_SEND_TIMEOUT_MS  100    // Backpressure no modo de velocidade máxima
+#define LAT_HIST_BUCKETS        24     // Histograma log2 de latência (1 us .. 16 s)
+
+/* Gravador de trace (ligado em trace_hooks.h com TRACE_RECORDER_ENABLED) */
+#define TRACE_RING_EVENTS       512    // Eventos por núcleo em cada janela gravada
+#define TRACE_MAX_TASKS         16
+#define TRACE_MAX_OBJECTS       32
+#define TRACE_ID_UNKNOWN        0xFFFF
+
+/* Estatísticas do escalonador (ligadas em trace_hooks.h com SCHED_STATS_ENABLED) */
+#define SCHED_MAX_TASKS         16     // Tarefas acompanhadas (recriadas ocupam outra entrada)
+
+/* Formato de saída do transmissor */
+#define TX_FORMAT_TEXT          0      // Linhas legíveis (">>> TRANSMITINDO")
+#define TX_FORMAT_BINARY        1      // Quadros binários com CRC32
+#define TX_FORMAT               TX_FORMAT_BINARY
+#define TX_FRAME_MTU            256    // Tamanho máximo de um quadro binário
+#define TX_CODEC_NONE           0      // Registros int32 brutos
+#define TX_CODEC_DELTA          1      // Delta + zigzag varint + RLE de deltas repetidos
+#define TX_CODEC                TX_CODEC_DELTA
+#define TX_CODEC_KEYFRAME_INTERVAL 8   // Quadros entre keyframes (ressincronização)
+
+/* Protocolo binário (little-endian):
+ *   sync (A5 5A) | len u16 | count u16 | count * int32 | crc32 u32
+ * len = bytes de registros; o CRC32 (IEEE) cobre len, count e registros. */
+#define WIRE_SYNC_0             0xA5
+#define WIRE_SYNC_1             0x5A
+#define WIRE_HEADER_SIZE        6
+#define WIRE_CRC_SIZE           4
+#define WIRE_RECORD_SIZE        4
+#define WIRE_MAX_RECORDS        ((TX_FRAME_MTU - WIRE_HEADER_SIZE - WIRE_CRC_SIZE) / WIRE_RECORD_SIZE)
+
+/* Quadro comprimido (TX_CODEC_DELTA):
+ *   sync (A5 5C) | len u16 | count u16 | seq u8 | flags u8 | tokens | crc32 u32
+ * Cada token é um varint t: t par -> delta = unzigzag(t >> 1);
+ * t ímpar -> repete o último delta (t >> 1) vezes. Em um keyframe
+ * (flags bit 0) o valor anterior e o último delta voltam a zero, então o
+ * decodificador pode ressincronizar nele após uma perda. */
+#define WIRE_SYNC_1_DELTA       0x5C
+#define WIRE_DELTA_HEADER_SIZE  8
+#define WIRE_FLAG_KEYFRAME      0x01
+#define WIRE_VARINT_MAX         5      // Bytes máximos de um token (33 bits)
+
+/* Faixas de prioridade do transporte (urgente antes de bulk) */
+#define LANE_URGENT_LENGTH      4      // Capacidade da faixa urgente (bulk usa QUEUE_LENGTH)
+#define LANE_BURST              4      // Urgentes seguidas antes de servir uma bulk pendente
+#define GEN_ALARM_INTERVAL      10     // Cada N-ésimo valor gerado é um alarme (faixa urgente)
+#define LANE_TRANSPORT_QUEUE    0      // Fila FreeRTOS: slots de tamanho fixo
+#define LANE_TRANSPORT_MSGBUF   1      // Message buffer: registros com prefixo de tamanho
+#define LANE_TRANSPORT_STREAM   2      // Stream buffer: registros fixos sem prefixo, lote numa cópia
+#define LANE_TRANSPORT_SPSC     3      // Anel lock-free de um produtor e um consumidor
+#define LANE_TRANSPORT_NOTIFY   4      // Caixa postal de um slot; produtor acordado por notificação
+#define LANE_TRANSPORT          LANE_TRANSPORT_QUEUE
+#define XPORT_BENCHMARK_ENABLED 0      // Mesma carga em todos os transportes no boot
+#define XPORT_BENCH_MESSAGES    20000  // Mensagens por fase do benchmark
+#define XPORT_BENCH_LENGTH      16     // Capacidade de cada transporte no benchmark
+#define XPORT_BENCH_BATCH       8      // Mensagens por lote na fase de lotes
+#define XPORT_BENCH_RAM         4096   // Fase de payloads variáveis: bytes de armazenamento de cada transporte
+#define XPORT_BENCH_MAX_PAYLOAD 256    // ...maior payload (tamanho do slot dos transportes de slot fixo)
+
+/* Microbenchmarks das primitivas usadas pelo pipeline (no boot) */
+#define MICROBENCH_ENABLED      0
+#define MICROBENCH_SAMPLES      30     // Amostras por primitiva
+#define MICROBENCH_T95          2.045  // t de Student, 95%, MICROBENCH_SAMPLES - 1 graus de liberdade
+#define MICROBENCH_QUEUE_LENGTH 16     // Itens por amostra nas medidas de fila
+
+/* Origem dos dados do gerador */
+#define GEN_SOURCE_TASK         0      // Tarefa dedicada com delay entre valores
+#define GEN_SOURCE_TIMER        1      // Alarme do gptimer: o ISR envia com as APIs FromISR
+#define GEN_SOURCE              GEN_SOURCE_TASK
+#define GEN_TIMER_RESOLUTION_HZ 1000000  // 1 tick = 1 us
+#define GEN_RATE_PROBE_ENABLED  1      // Encurta o período até haver descartes (modo timer)
+#define GEN_RATE_PROBE_MIN_US   100    // Menor período tentado pela sonda
+
+#if GEN_SOURCE == GEN_SOURCE_TIMER && REPLAY_MODE != REPLAY_MODE_OFF
+#error "Gravação/replay usam a tarefa do gerador (GEN_SOURCE_TASK)"
+#endif
+
+/* Canal de controle (supervisor/console -> tarefas gerenciadas) */
+#define CTL_QUEUE_LENGTH        4      // Comandos pendentes por tarefa
+#define CTL_ACK_QUEUE_LENGTH    8      // Confirmações pendentes para o supervisor
+#define CTL_ACK_TIMEOUT_MS      1500   // Espera de um ack síncrono (acima do rcv_delay máximo)
+#define CTL_PROBE_MARGIN_MS     200    // Sondagem do receptor: rcv_delay em uso + esta folga
+#define CTL_PAUSED_WAIT_MS      (LIVENESS_CHECK_PERIOD_MS / 2)  // Tarefa pausada ainda sinaliza progresso
+#define CTL_BACKOFF_MAX_FACTOR  8      // Período máximo do gerador sob descartes (x gen_period)
 
 /* Timeouts e limites */
 #define QUEUE_SEND_TIMEOUT_MS   0      // Não bloqueia se fila cheia
-#define QUEUE_RECV_TIMEOUT_MS   2000   // Timeout para recepção
+#define GENERATOR_PERIOD_MS     200    // Intervalo entre gerações
+#define RECEIVER_LOOP_DELAY_MS  50     // Pausa do receptor após cada iteração
+#define QUEUE_RECV_TIMEOUT_MS   2000   // Timeout inicial de recepção (até haver amostras)
 #define SUPERVISOR_PERIOD_MS    3000
 #define MAX_WARNINGS            3
 #define MAX_RECOVERIES          5
 #define MAX_SHUTDOWNS           10
+#define HEARTBEAT_STALE_MS      (2 * SUPERVISOR_PERIOD_MS)  // Idade máxima de um heartbeat
+
+/* Timeout adaptativo de recepção (derivado do intervalo entre chegadas) */
+#define RECV_TIMEOUT_MIN_MS     250    // Limite inferior do timeout adaptativo
+#define RECV_TIMEOUT_MAX_MS     4000   // Limite superior (abaixo do TWDT)
+#define RECV_TIMEOUT_K_SIGMA    4.0f   // timeout = média + K * desvio padrão
+#define RECV_TIMEOUT_MEAN_MULT  2.0f   // ...e nunca menos que 2x a média
+#define INTERARRIVAL_ALPHA      0.125f // Peso das novas amostras na EWMA
+#define INTERARRIVAL_MIN_SAMPLES 4     // Amostras antes de sair do timeout inicial
+
+/* Liveness: as tarefas só contam progresso; o supervisor alimenta o TWDT */
+#define LIVENESS_ENABLED          1      // 0 = esp_task_wdt_reset() direto a cada iteração
+#define LIVENESS_CHECK_PERIOD_MS  1000   // Intervalo de verificação e alimentação do TWDT
+#define LIVENESS_DEADLINE_GEN_MS  1000   // Prazo máximo sem progresso do gerador
+#define LIVENESS_DEADLINE_RCV_MS  (RECV_TIMEOUT_MAX_MS + 1000)  // ...do receptor
+#define LIVENESS_MEASURE_OVERHEAD 1      // Mede ciclos gastos no ponto de liveness do laço
+
+/* Baixo consumo para tráfego esparso: as tarefas bloqueiam só em eventos, o
+ * agente de liveness passa a um esp_timer e o idle entra em light sleep.
+ * Requer no sdkconfig CONFIG_PM_ENABLE e CONFIG_FREERTOS_USE_TICKLESS_IDLE;
+ * a ociosidade no relatório requer CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS. */
+#define LOW_POWER_ENABLED       0
+#define LOW_POWER_MAX_FREQ_MHZ  240
+#define LOW_POWER_MIN_FREQ_MHZ  40     // Frequência do XTAL com o DFS em repouso
+#define LOW_POWER_LIGHT_SLEEP   1      // Light sleep automático quando nada está pronto
+#define LOW_POWER_CONSOLE_POLL_MS 500  // O stdin não bloqueia: consulta espaçada
+#define LOW_POWER_RECV_TIMEOUT_MAX_MS 50000  // Teto dos recv_tmo* (abaixo do máximo de live_rcv)
+
+#if LOW_POWER_ENABLED && !LIVENESS_ENABLED
+#error "LOW_POWER_ENABLED requer LIVENESS_ENABLED (o TWDT é alimentado pelo timer do agente)"
+#endif
+
+// Com o TWDT alimentado pelo agente, o timeout de recepção é limitado pelo liveness
+#if LOW_POWER_ENABLED
+#define RECV_TIMEOUT_CFG_MAX_MS LOW_POWER_RECV_TIMEOUT_MAX_MS
+#else
+#define RECV_TIMEOUT_CFG_MAX_MS (TWDT_TIMEOUT_S * 1000 - 1000)
+#endif
+
+/* Injeção de falhas (mede detecção e recuperação do supervisor) */
+#define FAULT_INJECTION_ENABLED 0      // Compila os pontos de injeção e a tarefa de falhas
+#define FAULT_AUTORUN           1      // Roda todos os cenários em sequência após o boot
+#define FAULT_WARMUP_MS         10000  // Espera o sistema estabilizar antes do primeiro cenário
+#define FAULT_SETTLE_MS         5000   // Pausa entre cenários
+#define FAULT_SCENARIO_TIMEOUT_MS 30000  // Desiste se não houver recuperação
+#define FAULT_POLL_MS           50     // Resolução dos laços de falha e do console
+#define FAULT_STALL_MS          3000   // Duração do travamento do gerador
+#define FAULT_MALLOC_MS         2000   // Duração das falhas de alocação
+#define FAULT_CORRUPT_MS        2000   // Duração da corrupção de mensagens
+#define FAULT_SLOW_CONSOLE_MS   8000   // Duração do sink lento
+#define FAULT_SLOW_WRITE_MS     4000   // Atraso de cada escrita no sink lento
+#define FAULT_TASK_STACK_SIZE   3072
+#define FAULT_TASK_PRIO         2
+#define FAULT_RTC_MAGIC         0xFA17C0DEu
 
 /* Event Group Flags */
 #define FLAG_GENERATOR_OK       BIT0
@@ -37,258 +233,4682 @@
 #define FLAG_RECEIVER_WARNING   BIT2
 #define FLAG_RECEIVER_RECOVERY  BIT3
 #define FLAG_RECEIVER_SHUTDOWN  BIT4
+#define STATUS_FLAG_COUNT       5
+#define STATUS_FLAG_MASK        ((1u << STATUS_FLAG_COUNT) - 1)
+#define STATUS_PUBLISH_TRANSITIONS_ONLY 1  // 0 = chama o Event Group em toda atualização
+#define STATUS_MEASURE_OVERHEAD 1      // Mede ciclos por atualização de flags
+
+/* Métricas de recuperação (incidentes derivados das transições dos flags) */
+#define RELIABILITY_WINDOW          8      // Incidentes na média móvel de MTTR/MTBF
+#define RELIABILITY_TARGET_MTTR_MS  10000  // Meta: tempo médio até recuperar
+#define RELIABILITY_TARGET_MTBF_MS  60000  // Meta: tempo médio de operação entre incidentes
+
+/* Eventos notificados ao supervisor (bits do valor de notificação) */
+#define SUP_EVT_RECEIVER_ESCALATION  BIT0   // Receptor mudou de nível de escalonamento
+#define SUP_EVT_RECEIVER_SHUTDOWN    BIT1   // Receptor encerrou (nível 4)
+#define SUP_EVT_CONFIG_CHANGED       BIT2   // Parâmetro alterado em tempo de execução
+#define SUP_EVT_CTL_ACK              BIT3   // Confirmação de comando de controle pendente
+#define SUP_EVT_STATUS_REQUEST       BIT4   // Console pediu o relatório completo em texto
+#define SUPERVISOR_EVENT_DRIVEN      1      // 0 = polling a cada SUPERVISOR_PERIOD_MS
+
+/* Relatório periódico do supervisor */
+#define STATUS_REPORT_TEXT      0      // Bloco legível a cada período
+#define STATUS_REPORT_JSON      1      // Uma linha JSON por registro (tools/status_parser.py)
+#define STATUS_REPORT           STATUS_REPORT_TEXT
+#define STATUS_JSON_ON_CHANGE   1      // JSON: só emite em mudança ou no heartbeat lento
+#define STATUS_JSON_HEARTBEAT_MS 30000 // JSON: intervalo máximo entre registros
+#define STATUS_JSON_MAX         1280   // Bytes de uma linha JSON (pior caso ~1225 com todos os campos na largura máxima)
+
+/* Configuração em tempo de execução e console */
+#define CFG_NVS_NAMESPACE       "cfg"
+#define CONSOLE_TASK_STACK_SIZE 3072
+#define CONSOLE_TASK_PRIO       2
+#if LOW_POWER_ENABLED
+#define CONSOLE_POLL_MS         LOW_POWER_CONSOLE_POLL_MS
+#else
+#define CONSOLE_POLL_MS         50
+#endif
+#define CONSOLE_LINE_MAX        48
+
+/* Identificador personalizado */
+#define USER_ID "{Lucas-RM86920}"
+
+/* Tags personalizadas */
+#define TAG_GEN USER_ID " [GERADOR]"
+#define TAG_RCV USER_ID " [RECEPTOR]"
+#define TAG_SUP USER_ID " [SUPERVISOR]"
+#define TAG_QUEUE USER_ID " [FILA]"
+#define TAG_WDT USER_ID " [WATCHDOG]"
+#define TAG_MEM USER_ID " [MEMORIA]"
+#define TAG_MAIN USER_ID " [SISTEMA]"
+#define TAG_TX USER_ID " [TRANSMISSOR]"
+#define TAG_FAULT USER_ID " [FALHAS]"
+#define TAG_CFG USER_ID " [CONFIG]"
+#define TAG_CTL USER_ID " [CONTROLE]"
+
+/* ========== VARIÁVEIS GLOBAIS ========== */
+/* Parâmetros de configuração (inteiros; a unidade vem do tipo) */
+typedef enum {
+    CFG_QUEUE_LENGTH = 0,
+    CFG_URGENT_LENGTH,
+    CFG_LANE_BURST,
+    CFG_GENERATOR_PRIO,
+    CFG_RECEIVER_PRIO,
+    CFG_SUPERVISOR_PRIO,
+    CFG_TRANSMITTER_PRIO,
+    CFG_GENERATOR_STACK,
+    CFG_RECEIVER_STACK,
+    CFG_SUPERVISOR_STACK,
+    CFG_TRANSMITTER_STACK,
+    CFG_GENERATOR_PERIOD_MS,
+    CFG_RECEIVER_DELAY_MS,
+    CFG_SEND_TIMEOUT_MS,
+    CFG_RECV_TIMEOUT_MS,
+    CFG_RECV_TIMEOUT_MIN_MS,
+    CFG_RECV_TIMEOUT_MAX_MS,
+    CFG_SUPERVISOR_PERIOD_MS,
+    CFG_HEARTBEAT_STALE_MS,
+    CFG_MAX_WARNINGS,
+    CFG_MAX_RECOVERIES,
+    CFG_MAX_SHUTDOWNS,
+    CFG_LIVENESS_GEN_MS,
+    CFG_LIVENESS_RCV_MS,
+    CFG_TX_FLUSH_MS,
+    CFG_COUNT
+} cfg_id_t;
+
+typedef enum {
+    CFG_TYPE_COUNT = 0,         // Contador/limiar adimensional
+    CFG_TYPE_MS,
+    CFG_TYPE_PRIO,              // Prioridade FreeRTOS
+    CFG_TYPE_BYTES,
+} cfg_type_t;
+
+typedef struct {
+    const char *key;            // Chave no NVS e no console (até 15 caracteres)
+    cfg_type_t type;
+    int32_t def;
+    int32_t min;
+    int32_t max;
+    bool hot;                   // Aplicado na hora; senão vale a partir do próximo boot
+} cfg_param_t;
+
+static const cfg_param_t cfg_params[CFG_COUNT] = {
+    [CFG_QUEUE_LENGTH]         = { "queue_len",   CFG_TYPE_COUNT, QUEUE_LENGTH,           1,    64,    false },
+    [CFG_URGENT_LENGTH]        = { "urgent_len",  CFG_TYPE_COUNT, LANE_URGENT_LENGTH,     1,    32,    false },
+    [CFG_LANE_BURST]           = { "lane_burst",  CFG_TYPE_COUNT, LANE_BURST,             1,    64,    true },
+    [CFG_GENERATOR_PRIO]       = { "gen_prio",    CFG_TYPE_PRIO,  GENERATOR_TASK_PRIO,    1,    20,    false },
+    [CFG_RECEIVER_PRIO]        = { "rcv_prio",    CFG_TYPE_PRIO,  RECEIVER_TASK_PRIO,     1,    20,    false },
+    [CFG_SUPERVISOR_PRIO]      = { "sup_prio",    CFG_TYPE_PRIO,  SUPERVISOR_TASK_PRIO,   1,    20,    false },
+    [CFG_TRANSMITTER_PRIO]     = { "tx_prio",     CFG_TYPE_PRIO,  TRANSMITTER_TASK_PRIO,  1,    20,    false },
+    [CFG_GENERATOR_STACK]      = { "gen_stack",   CFG_TYPE_BYTES, GENERATOR_STACK_SIZE,   2048, 16384, false },
+    [CFG_RECEIVER_STACK]       = { "rcv_stack",   CFG_TYPE_BYTES, RECEIVER_STACK_SIZE,    2048, 16384, false },
+    [CFG_SUPERVISOR_STACK]     = { "sup_stack",   CFG_TYPE_BYTES, SUPERVISOR_STACK_SIZE,  2048, 16384, false },
+    [CFG_TRANSMITTER_STACK]    = { "tx_stack",    CFG_TYPE_BYTES, TRANSMITTER_STACK_SIZE, 2048, 16384, false },
+    [CFG_GENERATOR_PERIOD_MS]  = { "gen_period",  CFG_TYPE_MS,    GENERATOR_PERIOD_MS,    1,    10000, true },
+    [CFG_RECEIVER_DELAY_MS]    = { "rcv_delay",   CFG_TYPE_MS,    RECEIVER_LOOP_DELAY_MS, 0,    1000,  true },
+    [CFG_SEND_TIMEOUT_MS]      = { "send_tmo",    CFG_TYPE_MS,    QUEUE_SEND_TIMEOUT_MS,  0,    1000,  true },
+    [CFG_RECV_TIMEOUT_MS]      = { "recv_tmo",    CFG_TYPE_MS,    QUEUE_RECV_TIMEOUT_MS,  50,   RECV_TIMEOUT_CFG_MAX_MS, true },
+    [CFG_RECV_TIMEOUT_MIN_MS]  = { "recv_tmo_min", CFG_TYPE_MS,   RECV_TIMEOUT_MIN_MS,    10,   RECV_TIMEOUT_CFG_MAX_MS, true },
+    [CFG_RECV_TIMEOUT_MAX_MS]  = { "recv_tmo_max", CFG_TYPE_MS,   RECV_TIMEOUT_MAX_MS,    10,   RECV_TIMEOUT_CFG_MAX_MS, true },
+    [CFG_SUPERVISOR_PERIOD_MS] = { "sup_period",  CFG_TYPE_MS,    SUPERVISOR_PERIOD_MS,   100,  60000, true },
+    [CFG_HEARTBEAT_STALE_MS]   = { "hb_stale",    CFG_TYPE_MS,    HEARTBEAT_STALE_MS,     500,  120000, true },
+    [CFG_MAX_WARNINGS]         = { "max_warn",    CFG_TYPE_COUNT, MAX_WARNINGS,           1,    100,   true },
+    [CFG_MAX_RECOVERIES]       = { "max_recov",   CFG_TYPE_COUNT, MAX_RECOVERIES,         2,    100,   true },
+    [CFG_MAX_SHUTDOWNS]        = { "max_shut",    CFG_TYPE_COUNT, MAX_SHUTDOWNS,          3,    100,   true },
+    [CFG_LIVENESS_GEN_MS]      = { "live_gen",    CFG_TYPE_MS,    LIVENESS_DEADLINE_GEN_MS, 100, 60000, true },
+    [CFG_LIVENESS_RCV_MS]      = { "live_rcv",    CFG_TYPE_MS,    LIVENESS_DEADLINE_RCV_MS, 100, 60000, true },
+    [CFG_TX_FLUSH_MS]          = { "tx_flush",    CFG_TYPE_MS,    TX_FLUSH_MS,            10,   10000, true },
+};
+
+static atomic_int cfg_values[CFG_COUNT];   // Valores em uso (lidos sem lock pelos laços)
+
+/* Mensagem trafegada nas faixas: o CRC32 cobre todos os campos anteriores */
+typedef struct {
+    uint32_t seq;               // Número de sequência por faixa, atribuído pelo gerador
+    int32_t value;
+    uint32_t sent_us;           // esp_timer no envio (32 bits baixos), para latência
+    uint8_t lane;               // lane_id_t: faixa em que a mensagem trafega
+    uint8_t reserved[3];        // Zerado: sem padding implícito sob o CRC
+    uint32_t crc;
+} data_msg_t;
+
+/* Faixas do transporte: uma fila por faixa e uma campainha (semáforo
+ * contador) com uma ficha por mensagem enfileirada em qualquer faixa */
+typedef enum {
+    LANE_URGENT = 0,            // Alarmes: sempre drenada primeiro
+    LANE_BULK,                  // Telemetria
+    LANE_COUNT
+} lane_id_t;
+
+/* Transportes: todos com a mesma interface (xport_<impl>_create, _send,
+ * _send_from_isr, _send_batch, _receive, _receive_batch, _depth, _reset e o
+ * campo stats), escolhida em tempo de compilação. Um produtor (gerador ou
+ * seu ISR) e um consumidor (receptor) por instância; receive e reset só no
+ * consumidor. */
+typedef struct {
+    uint32_t peak_depth;        // Maior ocupação vista pelo produtor
+    uint32_t full;              // Envios recusados por falta de espaço
+    uint32_t storage_bytes;     // Armazenamento alocado
+} xport_stats_t;
+
+typedef struct {
+    QueueHandle_t handle;
+    xport_stats_t stats;
+} xport_queue_t;
+
+typedef struct {
+    MessageBufferHandle_t handle;
+    size_t capacity;            // Bytes: registro = mensagem + prefixo de tamanho
+    xport_stats_t stats;
+} xport_msgbuf_t;
+
+typedef struct {
+    StreamBufferHandle_t handle;
+    size_t capacity;
+    xport_stats_t stats;
+} xport_stream_t;
+
+typedef struct {
+    data_msg_t *slots;
+    uint32_t size;              // Capacidade + 1: um slot fica vago para distinguir cheio de vazio
+    atomic_uint head;           // Só o produtor escreve
+    atomic_uint tail;           // Só o consumidor escreve
+    xport_stats_t stats;
+} xport_spsc_t;
+
+typedef struct {
+    data_msg_t slot;
+    atomic_bool full;
+    portMUX_TYPE lock;          // Protege a entrega do handle do produtor em espera
+    TaskHandle_t waiting_writer;
+    atomic_bool notifying;      // Consumidor entre pegar o handle e notificar
+    xport_stats_t stats;
+} xport_notify_t;
+
+#if LANE_TRANSPORT == LANE_TRANSPORT_MSGBUF
+typedef xport_msgbuf_t lane_xport_t;
+#define LANE_XPORT(op)          xport_msgbuf_##op
+#elif LANE_TRANSPORT == LANE_TRANSPORT_STREAM
+typedef xport_stream_t lane_xport_t;
+#define LANE_XPORT(op)          xport_stream_##op
+#elif LANE_TRANSPORT == LANE_TRANSPORT_SPSC
+typedef xport_spsc_t lane_xport_t;
+#define LANE_XPORT(op)          xport_spsc_##op
+#elif LANE_TRANSPORT == LANE_TRANSPORT_NOTIFY
+typedef xport_notify_t lane_xport_t;
+#define LANE_XPORT(op)          xport_notify_##op
+#else
+typedef xport_queue_t lane_xport_t;
+#define LANE_XPORT(op)          xport_queue_##op
+#endif
+
+static lane_xport_t lane_xports[LANE_COUNT];
+static SemaphoreHandle_t lane_doorbell = NULL;
+static const char *const lane_names[LANE_COUNT] = { "urgente", "bulk" };
+
+/* Espera única do receptor: o QueueSet cobre a campainha das faixas e o
+ * canal de controle do receptor */
+typedef enum {
+    RX_WAIT_TIMEOUT = 0,
+    RX_WAIT_DATA,
+    RX_WAIT_CTRL,
+} rx_wait_result_t;
+
+static QueueSetHandle_t rx_wait_set = NULL;
+static uint32_t rx_deferred_tokens = 0;     // Fichas retidas com o receptor pausado
+static EventGroupHandle_t status_flags = NULL;
+#if GEN_SOURCE == GEN_SOURCE_TASK
+static TaskHandle_t generator_task_handle = NULL;
+#endif
+static TaskHandle_t receiver_task_handle = NULL;
+static TaskHandle_t supervisor_task_handle = NULL;
+static TaskHandle_t transmitter_task_handle = NULL;
+static TaskHandle_t console_task_handle = NULL;
+
+/* Heartbeats para monitoramento: escritos por uma única tarefa (núcleo 1) e
+ * lidos sem lock pelo supervisor (núcleo 0). Seqlock: o campo seq fica
+ * ímpar durante a escrita e o leitor repete a leitura se ele mudar. */
+typedef struct {
+    atomic_uint seq;
+    atomic_uint ts_lo;          // Timestamp monotônico (esp_timer, us), 32 bits baixos
+    atomic_uint ts_hi;          // ...32 bits altos
+    atomic_uint iterations;     // Contador de iterações (comparado com aritmética modular)
+} heartbeat_t;
+
+typedef struct {
+    uint64_t timestamp_us;
+    uint32_t iterations;
+} heartbeat_snapshot_t;
+
+static heartbeat_t generator_heartbeat;
+static heartbeat_t receiver_heartbeat;
+
+/* Registro de liveness por tarefa monitorada */
+typedef enum {
+    LIVENESS_GENERATOR = 0,
+    LIVENESS_RECEIVER,
+    LIVENESS_TASK_COUNT
+} liveness_id_t;
+
+typedef struct {
+    const char *name;
+    cfg_id_t deadline;          // Prazo máximo sem progresso (parâmetro em ms)
+    atomic_uint progress;       // Incrementado pela própria tarefa a cada iteração
+    atomic_bool registered;
+    uint32_t last_seen;         // Último progresso observado pelo agente
+    int64_t last_progress_us;   // Quando o agente viu progresso pela última vez
+    uint32_t overhead_cycles;   // Ciclos acumulados no ponto de liveness
+    uint32_t overhead_calls;
+} liveness_slot_t;
+
+static liveness_slot_t liveness_slots[LIVENESS_TASK_COUNT] = {
+    [LIVENESS_GENERATOR] = { .name = "gerador",  .deadline = CFG_LIVENESS_GEN_MS },
+    [LIVENESS_RECEIVER]  = { .name = "receptor", .deadline = CFG_LIVENESS_RCV_MS },
+};
+
+#if LIVENESS_ENABLED
+static esp_task_wdt_user_handle_t liveness_wdt_user = NULL;
+#endif
+
+/* Despertares por núcleo: o gancho de idle roda uma vez por interrupção */
+static atomic_uint idle_wakeups[portNUM_PROCESSORS];
+
+/* Estimador do intervalo entre chegadas (escrito só pelo receptor) */
+typedef struct {
+    float mean_ms;              // EWMA do intervalo entre chegadas
+    float var_ms2;              // EWMA da variância do intervalo
+    uint32_t samples;
+    int64_t last_arrival_us;
+} interarrival_estimator_t;
+
+static interarrival_estimator_t rx_interarrival;
+
+/* Buffers de transmissão: o receptor preenche um lote enquanto o
+ * transmissor escoa o outro. As filas circulam apenas índices. */
+typedef struct {
+    int values[TX_BATCH_SIZE];
+    uint32_t count;
+} tx_batch_t;
+
+typedef struct {
+    uint32_t batches;           // Lotes escritos no sink
+    uint32_t values;            // Valores transmitidos
+    uint32_t bytes;             // Bytes escritos (delta modular entre relatórios)
+    uint32_t write_us;          // Tempo bloqueado na escrita do sink
+    uint32_t stall_us;          // Tempo em que o receptor ficou sem buffer livre
+    uint32_t dropped;           // Valores descartados por falta de buffer
+    uint32_t peak_in_use;       // Pico de buffers ocupados
+    uint32_t encode_cycles;     // Ciclos gastos codificando lotes
+} tx_stats_t;
+
+static tx_batch_t tx_batches[TX_NUM_BUFFERS];
+static QueueHandle_t tx_free_queue = NULL;      // Índices de buffers livres
+static QueueHandle_t tx_ready_queue = NULL;     // Índices de lotes prontos
+static int tx_fill_index = -1;                  // Lote em preenchimento (só o receptor)
+static uint32_t tx_batch_limit = TX_BATCH_SIZE; // Valores por lote (CTL_SET_BATCH, só o receptor)
+static int64_t tx_fill_start_us = 0;
+static int64_t tx_stall_start_us = 0;
+static tx_stats_t tx_stats;
+
+/* Verificação de integridade no receptor */
+static uint32_t integrity_checked = 0;
+static uint32_t integrity_errors = 0;
+
+/* Histograma de latência (bucket i cobre [2^i, 2^(i+1)) us) */
+typedef struct {
+    uint32_t buckets[LAT_HIST_BUCKETS];
+    uint32_t count;
+    uint32_t max_us;
+} latency_hist_t;
+
+static latency_hist_t rx_latency;   // Envio no gerador -> recepção (só o receptor escreve)
+static latency_hist_t rx_wakeup_latency;    // ...só das mensagens que acordaram o receptor ocioso
+
+typedef struct {
+    uint32_t sent;
+    uint32_t dropped;           // Faixa cheia no envio (escrito só pelo produtor)
+    uint32_t received;
+    latency_hist_t latency;     // Escrito só pelo receptor
+} lane_stats_t;
+
+static lane_stats_t lane_stats[LANE_COUNT];
+
+/* Canal de controle: uma fila de comandos por tarefa gerenciada e uma fila
+ * de confirmações consumida só pelo supervisor */
+typedef enum {
+    CTL_PAUSE = 0,              // Para de produzir/consumir, mas segue respondendo
+    CTL_RESUME,
+    CTL_SET_RATE,               // Gerador: período em ms (0 = volta ao gen_period)
+    CTL_SET_BATCH,              // Receptor: valores por lote de transmissão
+    CTL_DRAIN,                  // Receptor: processa o que está nas faixas e escoa o lote
+    CTL_RESET_COUNTERS,         // Zera os contadores escritos pela própria tarefa
+    CTL_RESET_LANES,            // Receptor: descarta as mensagens pendentes
+    CTL_SHUTDOWN,               // Receptor: encerra de forma limpa (o supervisor recria)
+    CTL_COUNT
+} ctl_cmd_t;
+
+typedef enum {
+    CTL_OK = 0,
+    CTL_UNSUPPORTED,            // Comando sem efeito nesta tarefa
+    CTL_INVALID_ARG,
+    CTL_TIMEOUT,                // Sem ack no prazo (registrado pelo supervisor)
+    CTL_RESULT_COUNT
+} ctl_result_t;
+
+typedef struct {
+    uint8_t cmd;                // ctl_cmd_t
+    uint16_t seq;
+    int32_t arg;
+    int64_t sent_us;            // esp_timer no envio, para a latência do comando
+} ctl_msg_t;
+
+typedef struct {
+    uint8_t task;               // liveness_id_t
+    uint8_t cmd;
+    uint8_t result;             // ctl_result_t
+    uint16_t seq;
+    uint32_t latency_us;        // Envio -> comando aplicado pela tarefa
+} ctl_ack_t;
+
+typedef struct {
+    uint32_t acked;
+    uint32_t failed;            // Ack com resultado diferente de CTL_OK
+    uint32_t timeouts;
+    latency_hist_t latency;     // Só o supervisor escreve
+} ctl_stats_t;
+
+static QueueHandle_t ctl_queues[LIVENESS_TASK_COUNT];
+static QueueHandle_t ctl_ack_queue = NULL;
+static atomic_uint ctl_next_seq;
+static ctl_stats_t ctl_stats[CTL_COUNT];
+static const char *const ctl_names[CTL_COUNT] = {
+    "pause", "resume", "rate", "batch", "drain", "reset_counters", "reset_lanes", "shutdown",
+};
+static const char *const ctl_result_names[CTL_RESULT_COUNT] = {
+    "ok", "não suportado", "argumento inválido", "sem resposta",
+};
+
+/* Amostra do fluxo do gerador: 8 bytes little-endian no arquivo gravado */
+typedef struct {
+    uint32_t delta_us;          // Intervalo desde a amostra anterior
+    int32_t value;
+} replay_sample_t;
+
+/* Latência entre a sinalização de falha e a ação do supervisor */
+static volatile int64_t receiver_shutdown_signal_us = 0;
+static int64_t fault_action_last_us = 0;
+static int64_t fault_action_max_us = 0;
+static uint32_t fault_action_count = 0;
+static atomic_bool status_text_requested;   // Console -> supervisor (funciona também em polling)
+
+/* Transições dos flags de status: o shadow espelha o Event Group e revela
+ * quais bits mudaram em cada chamada. Shadow e tempos mudam juntos sob o
+ * status_lock; o shadow segue atômico para leituras sem lock (ISR). */
+typedef struct {
+    int64_t last_set_us;        // Última transição 0 -> 1
+    int64_t last_clear_us;      // Última transição 1 -> 0
+    int64_t last_assert_us;     // Última vez que o bit foi (re)afirmado
+    uint32_t transitions;
+} status_flag_times_t;
+
+/* Incidente: do início da falha até o flag OK voltar. O início é a última
+ * afirmação do OK antes da degradação (última entrega bem-sucedida). */
+typedef struct {
+    const char *name;
+    EventBits_t ok_bit;
+    EventBits_t degraded_mask;  // Estados degradados acompanhados (podem ser 0)
+    bool open;
+    int64_t onset_us;
+    int64_t detect_us;          // Primeiro flag de degradação
+    int64_t degraded_us[STATUS_FLAG_COUNT];     // Tempo em cada estado no incidente atual
+    int64_t last_recover_us;    // Fim do incidente anterior (0 = boot)
+    uint32_t count;
+    int64_t last_detect_us;     // Latência de detecção do último incidente
+    int64_t last_ttr_us;        // Tempo até recuperar do último incidente
+    int64_t last_degraded_us[STATUS_FLAG_COUNT];
+    int64_t ttr_us[RELIABILITY_WINDOW];         // Janela móvel para o MTTR
+    int64_t uptime_us[RELIABILITY_WINDOW];      // ...e para o MTBF
+} incident_tracker_t;
+
+static atomic_uint status_shadow;
+#if STATUS_MEASURE_OVERHEAD
+static atomic_uint status_updates;          // Chamadas de status_update_bits()
+static atomic_uint status_publishes;        // ...que chegaram ao Event Group
+static atomic_uint status_cycles;
+#endif
+static status_flag_times_t status_times[STATUS_FLAG_COUNT];
+static portMUX_TYPE status_lock = portMUX_INITIALIZER_UNLOCKED;
+static incident_tracker_t receiver_incidents = {
+    .name = "receptor", .ok_bit = FLAG_RECEIVER_OK,
+    .degraded_mask = FLAG_RECEIVER_WARNING | FLAG_RECEIVER_RECOVERY | FLAG_RECEIVER_SHUTDOWN,
+};
+static incident_tracker_t generator_incidents = {
+    .name = "gerador", .ok_bit = FLAG_GENERATOR_OK,
+};
+
+/* Perda de dados: lacunas na sequência recebida (só o receptor escreve) */
+static uint32_t rx_last_seq[LANE_COUNT];
+static uint32_t rx_seq_gaps = 0;
+
+/* Cenários de falha injetável (um ativo por vez) */
+typedef enum {
+    FAULT_NONE = 0,
+    FAULT_GENERATOR_STALL,      // Gerador para de produzir e de sinalizar progresso
+    FAULT_RECEIVER_HANG,        // Receptor trava até ser recriado pelo supervisor
+    FAULT_MALLOC_FAIL,          // malloc() do receptor retorna NULL
+    FAULT_QUEUE_CORRUPT,        // Mensagem corrompida depois do cálculo do CRC
+    FAULT_SLOW_CONSOLE,         // Escritas lentas no sink de transmissão
+    FAULT_WDT_STARVATION,       // Agente de liveness deixa de alimentar o TWDT
+    FAULT_COUNT
+} fault_id_t;
+
+typedef struct {
+    const char *name;           // Nome usado no console ("fault <nome>")
+    uint32_t duration_ms;       // 0 = até a ação do supervisor
+} fault_scenario_t;
+
+typedef struct {
+    atomic_int active;          // fault_id_t do cenário em andamento
+    atomic_bool ended;          // Condição de falha já removida
+    atomic_bool detected;
+    atomic_bool recovered;
+    int64_t inject_us;
+    int64_t detect_us;
+    int64_t recover_us;
+    const char *detector;       // Primeiro mecanismo que percebeu a falha
+    uint32_t lost_start;        // Contador de perdas no momento da injeção
+} fault_state_t;
+
+typedef struct {
+    int64_t detect_ms;          // -1 = não detectada
+    int64_t recover_ms;         // -1 = não recuperou
+    uint32_t lost;
+    const char *detector;
+} fault_result_t;
+
+/* Sobrevive ao reset do TWDT para concluir o cenário de starvation */
+typedef struct {
+    uint32_t magic;
+    uint32_t scenario;
+    int64_t inject_us;
+    int64_t detect_us;          // ISR de timeout do TWDT (relógio anterior ao reset)
+    uint32_t in_flight;         // Mensagens na fila e no lote em preenchimento
+} fault_rtc_record_t;
+
+#if FAULT_INJECTION_ENABLED
+static const fault_scenario_t fault_scenarios[FAULT_COUNT] = {
+    [FAULT_NONE]            = { "nenhuma",  0 },
+    [FAULT_GENERATOR_STALL] = { "gerador",  FAULT_STALL_MS },
+    [FAULT_RECEIVER_HANG]   = { "receptor", 0 },
+    [FAULT_MALLOC_FAIL]     = { "malloc",   FAULT_MALLOC_MS },
+    [FAULT_QUEUE_CORRUPT]   = { "fila",     FAULT_CORRUPT_MS },
+    [FAULT_SLOW_CONSOLE]    = { "console",  FAULT_SLOW_CONSOLE_MS },
+    [FAULT_WDT_STARVATION]  = { "watchdog", 2 * TWDT_TIMEOUT_S * 1000 },  // Só termina sem reset se o TWDT falhar
+};
+
+static fault_state_t fault;
+static RTC_NOINIT_ATTR fault_rtc_record_t fault_rtc;
+static TaskHandle_t fault_task_handle = NULL;
+static QueueHandle_t fault_cmd_queue = NULL;    // Cenários pedidos pelo console
+#endif
+
+/* ========== CONFIGURAÇÃO EM TEMPO DE EXECUÇÃO ========== */
+static inline int32_t cfg_get(cfg_id_t id) {
+    return atomic_load_explicit(&cfg_values[id], memory_order_relaxed);
+}
+
+static cfg_id_t cfg_find(const char *key) {
+    for (int i = 0; i < CFG_COUNT; i++) {
+        if (strcmp(cfg_params[i].key, key) == 0) {
+            return (cfg_id_t)i;
+        }
+    }
+    return CFG_COUNT;
+}
+
+static bool cfg_in_bounds(cfg_id_t id, int32_t value) {
+    return value >= cfg_params[id].min && value <= cfg_params[id].max;
+}
+
+// Regras entre parâmetros; retorna a regra violada ou NULL
+static const char *cfg_check(const int32_t *v) {
+    if (!(v[CFG_MAX_WARNINGS] < v[CFG_MAX_RECOVERIES] && v[CFG_MAX_RECOVERIES] < v[CFG_MAX_SHUTDOWNS])) {
+        return "max_warn < max_recov < max_shut";
+    }
+    if (v[CFG_RECV_TIMEOUT_MIN_MS] > v[CFG_RECV_TIMEOUT_MAX_MS]) {
+        return "recv_tmo_min <= recv_tmo_max";
+    }
+    if (v[CFG_RECV_TIMEOUT_MS] < v[CFG_RECV_TIMEOUT_MIN_MS] || v[CFG_RECV_TIMEOUT_MS] > v[CFG_RECV_TIMEOUT_MAX_MS]) {
+        return "recv_tmo_min <= recv_tmo <= recv_tmo_max";
+    }
+    // Uma iteração ociosa do receptor bloqueia até o timeout e ainda dorme o rcv_delay
+    int32_t recv_wait_max = (v[CFG_RECV_TIMEOUT_MS] > v[CFG_RECV_TIMEOUT_MAX_MS]) ?
+                            v[CFG_RECV_TIMEOUT_MS] : v[CFG_RECV_TIMEOUT_MAX_MS];
+    if (v[CFG_LIVENESS_RCV_MS] <= recv_wait_max + v[CFG_RECEIVER_DELAY_MS]) {
+        return "live_rcv > max(recv_tmo, recv_tmo_max) + rcv_delay";
+    }
+    if (v[CFG_LIVENESS_GEN_MS] <= v[CFG_GENERATOR_PERIOD_MS]) {
+        return "live_gen > gen_period";
+    }
+    if (v[CFG_HEARTBEAT_STALE_MS] <= v[CFG_RECV_TIMEOUT_MAX_MS] ||
+        v[CFG_HEARTBEAT_STALE_MS] <= v[CFG_GENERATOR_PERIOD_MS]) {
+        return "hb_stale > recv_tmo_max e gen_period";
+    }
+    return NULL;
+}
+
+// Aplica as regras com um parâmetro trocado pelo valor candidato
+static const char *cfg_check_with(cfg_id_t id, int32_t value) {
+    int32_t values[CFG_COUNT];
+    for (int i = 0; i < CFG_COUNT; i++) {
+        values[i] = cfg_get((cfg_id_t)i);
+    }
+    values[id] = value;
+    return cfg_check(values);
+}
+
+// Carrega a tabela do NVS no boot; valores fora dos limites ficam no padrão
+static void cfg_load(void) {
+    int32_t values[CFG_COUNT];
+    int loaded = 0;
+    
+    for (int i = 0; i < CFG_COUNT; i++) {
+        values[i] = cfg_params[i].def;
+    }
+    
+    esp_err_t err = nvs_flash_init();
+    if (err == ESP_ERR_NVS_NO_FREE_PAGES || err == ESP_ERR_NVS_NEW_VERSION_FOUND) {
+        nvs_flash_erase();
+        err = nvs_flash_init();
+    }
+    
+    nvs_handle_t nvs;
+    if (err == ESP_OK && nvs_open(CFG_NVS_NAMESPACE, NVS_READONLY, &nvs) == ESP_OK) {
+        for (int i = 0; i < CFG_COUNT; i++) {
+            int32_t value;
+            if (nvs_get_i32(nvs, cfg_params[i].key, &value) != ESP_OK) {
+                continue;
+            }
+            if (cfg_in_bounds((cfg_id_t)i, value)) {
+                values[i] = value;
+                loaded++;
+            } else {
+                printf("%s AVISO: %s = %" PRId32 " fora de [%" PRId32 ", %" PRId32 "], usando %" PRId32 "\n",
+                       TAG_CFG, cfg_params[i].key, value, cfg_params[i].min, cfg_params[i].max, cfg_params[i].def);
+            }
+        }
+        nvs_close(nvs);
+    } else if (err != ESP_OK) {
+        printf("%s AVISO: NVS indisponível (%s), usando padrões\n", TAG_CFG, esp_err_to_name(err));
+    }
+    
+    const char *rule = cfg_check(values);
+    if (rule != NULL) {
+        printf("%s AVISO: configuração salva viola \"%s\", usando padrões\n", TAG_CFG, rule);
+        for (int i = 0; i < CFG_COUNT; i++) {
+            values[i] = cfg_params[i].def;
+        }
+        loaded = 0;
+    }
+    
+    for (int i = 0; i < CFG_COUNT; i++) {
+        atomic_store_explicit(&cfg_values[i], values[i], memory_order_relaxed);
+    }
+    printf("%s Configuração carregada (%d de %d parâmetros do NVS)\n", TAG_CFG, loaded, CFG_COUNT);
+}
+
+// Valida e persiste um parâmetro; os quentes passam a valer na hora.
+// Retorna o motivo da rejeição ou NULL.
+static const char *cfg_set(cfg_id_t id, int32_t value) {
+    if (!cfg_in_bounds(id, value)) {
+        return "fora dos limites";
+    }
+    
+    // As regras só envolvem parâmetros quentes: confere contra os valores em uso
+    const char *rule = cfg_check_with(id, value);
+    if (rule != NULL) {
+        return rule;
+    }
+    
+    nvs_handle_t nvs;
+    if (nvs_open(CFG_NVS_NAMESPACE, NVS_READWRITE, &nvs) != ESP_OK) {
+        return "NVS indisponível";
+    }
+    esp_err_t err = nvs_set_i32(nvs, cfg_params[id].key, value);
+    if (err == ESP_OK) {
+        err = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+    if (err != ESP_OK) {
+        return "falha ao gravar no NVS";
+    }
+    
+    if (cfg_params[id].hot) {
+        atomic_store_explicit(&cfg_values[id], value, memory_order_relaxed);
+    }
+    return NULL;
+}
+
+// Apaga os valores salvos; os quentes voltam ao padrão na hora
+static bool cfg_reset(void) {
+    nvs_handle_t nvs;
+    if (nvs_open(CFG_NVS_NAMESPACE, NVS_READWRITE, &nvs) != ESP_OK) {
+        return false;
+    }
+    esp_err_t err = nvs_erase_all(nvs);
+    if (err == ESP_OK) {
+        err = nvs_commit(nvs);
+    }
+    nvs_close(nvs);
+    
+    for (int i = 0; i < CFG_COUNT; i++) {
+        if (cfg_params[i].hot) {
+            atomic_store_explicit(&cfg_values[i], cfg_params[i].def, memory_order_relaxed);
+        }
+    }
+    return err == ESP_OK;
+}
+
+/* ========== PONTOS DE INJEÇÃO DE FALHAS ========== */
+// Verdadeiro enquanto a condição de falha do cenário estiver ativa
+static inline bool fault_active(fault_id_t id) {
+#if FAULT_INJECTION_ENABLED
+    return atomic_load_explicit(&fault.active, memory_order_relaxed) == (int)id &&
+           !atomic_load_explicit(&fault.ended, memory_order_relaxed);
+#else
+    (void)id;
+    return false;
+#endif
+}
+
+// Registra o primeiro mecanismo que percebeu a falha injetada
+static void fault_detected(const char *detector) {
+#if FAULT_INJECTION_ENABLED
+    if (atomic_load_explicit(&fault.active, memory_order_acquire) != FAULT_NONE &&
+        !atomic_exchange(&fault.detected, true)) {
+        fault.detect_us = esp_timer_get_time();
+        fault.detector = detector;
+    }
+#else
+    (void)detector;
+#endif
+}
+
+#if FAULT_INJECTION_ENABLED
+// Remove a condição de falha (idempotente)
+static void fault_end(void) {
+    atomic_store_explicit(&fault.ended, true, memory_order_release);
+}
+#endif
+
+// Primeiro valor entregue de ponta a ponta depois do fim da falha = recuperação
+static inline void fault_data_delivered(void) {
+#if FAULT_INJECTION_ENABLED
+    if (atomic_load_explicit(&fault.active, memory_order_acquire) != FAULT_NONE &&
+        atomic_load_explicit(&fault.ended, memory_order_acquire) &&
+        !atomic_exchange(&fault.recovered, true)) {
+        fault.recover_us = esp_timer_get_time();
+    }
+#endif
+}
+
+// Ação corretiva do supervisor: encerra as falhas que só ela remove
+static void fault_supervisor_action(void) {
+#if FAULT_INJECTION_ENABLED
+    int id = atomic_load_explicit(&fault.active, memory_order_acquire);
+    if (id != FAULT_NONE && fault_scenarios[id].duration_ms == 0) {
+        fault_end();
+    }
+#endif
+}
+
+/* ========== HEARTBEATS ========== */
+// Publica um novo heartbeat (apenas o dono do registro pode chamar)
+static void heartbeat_beat(heartbeat_t *hb) {
+    uint64_t now_us = (uint64_t)esp_timer_get_time();
+    uint32_t seq = atomic_load_explicit(&hb->seq, memory_order_relaxed);
+    uint32_t iterations = atomic_load_explicit(&hb->iterations, memory_order_relaxed);
+    
+    atomic_store_explicit(&hb->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&hb->ts_lo, (uint32_t)now_us, memory_order_relaxed);
+    atomic_store_explicit(&hb->ts_hi, (uint32_t)(now_us >> 32), memory_order_relaxed);
+    atomic_store_explicit(&hb->iterations, iterations + 1, memory_order_relaxed);
+    atomic_store_explicit(&hb->seq, seq + 2, memory_order_release);
+}
+
+// Lê um heartbeat consistente a partir de qualquer núcleo, sem lock
+static heartbeat_snapshot_t heartbeat_read(heartbeat_t *hb) {
+    heartbeat_snapshot_t snap;
+    uint32_t seq_before, seq_after;
+    
+    do {
+        seq_before = atomic_load_explicit(&hb->seq, memory_order_acquire);
+        uint32_t lo = atomic_load_explicit(&hb->ts_lo, memory_order_relaxed);
+        uint32_t hi = atomic_load_explicit(&hb->ts_hi, memory_order_relaxed);
+        snap.iterations = atomic_load_explicit(&hb->iterations, memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        seq_after = atomic_load_explicit(&hb->seq, memory_order_relaxed);
+        snap.timestamp_us = ((uint64_t)hi << 32) | lo;
+    } while ((seq_before & 1u) || seq_before != seq_after);
+    
+    return snap;
+}
+
+// Idade do último heartbeat em us (64 bits: sem wraparound na prática)
+static int64_t heartbeat_age_us(heartbeat_t *hb, int64_t now_us) {
+    int64_t age_us = now_us - (int64_t)heartbeat_read(hb).timestamp_us;
+    return (age_us > 0) ? age_us : 0;
+}
+
+/* ========== LIVENESS ========== */
+// Inscreve a tarefa atual no monitoramento (no TWDT, se liveness desligado)
+static void liveness_register(liveness_id_t id) {
+#if LIVENESS_ENABLED
+    liveness_slot_t *slot = &liveness_slots[id];
+    atomic_store_explicit(&slot->progress, atomic_load_explicit(&slot->progress, memory_order_relaxed) + 1,
+                          memory_order_relaxed);
+    atomic_store_explicit(&slot->registered, true, memory_order_release);
+#else
+    esp_task_wdt_add(NULL);
+#endif
+}
+
+// Remove uma tarefa do monitoramento (task == NULL para a tarefa atual)
+static void liveness_unregister(liveness_id_t id, TaskHandle_t task) {
+#if LIVENESS_ENABLED
+    atomic_store_explicit(&liveness_slots[id].registered, false, memory_order_release);
+#else
+    esp_task_wdt_delete(task);
+#endif
+}
+
+// Ponto de liveness do laço: contador local barato em vez de reset do TWDT
+static inline void task_alive(liveness_id_t id) {
+    liveness_slot_t *slot = &liveness_slots[id];
+#if LIVENESS_MEASURE_OVERHEAD
+    uint32_t start = esp_cpu_get_cycle_count();
+#endif
+    
+#if LIVENESS_ENABLED
+    // Escritor único: load + store relaxados, sem instrução atômica de RMW
+    atomic_store_explicit(&slot->progress, atomic_load_explicit(&slot->progress, memory_order_relaxed) + 1,
+                          memory_order_relaxed);
+#else
+    if (!fault_active(FAULT_WDT_STARVATION)) {
+        esp_task_wdt_reset();
+    }
+#endif
+    
+#if LIVENESS_MEASURE_OVERHEAD
+    slot->overhead_cycles += esp_cpu_get_cycle_count() - start;
+    slot->overhead_calls++;
+#else
+    (void)slot;
+#endif
+}
+
+#if LIVENESS_ENABLED
+// Agente único: alimenta o TWDT só se todas as tarefas progrediram no prazo
+static void liveness_check_and_feed(int64_t now_us) {
+    bool all_alive = true;
+    
+    for (int i = 0; i < LIVENESS_TASK_COUNT; i++) {
+        liveness_slot_t *slot = &liveness_slots[i];
+        if (!atomic_load_explicit(&slot->registered, memory_order_acquire)) {
+            continue;
+        }
+        
+        uint32_t progress = atomic_load_explicit(&slot->progress, memory_order_relaxed);
+        if (progress != slot->last_seen || slot->last_progress_us == 0) {
+            slot->last_seen = progress;
+            slot->last_progress_us = now_us;
+        } else if (now_us - slot->last_progress_us > (int64_t)cfg_get(slot->deadline) * 1000) {
+            printf("%s AVISO: Tarefa %s sem progresso há %" PRId64 " ms - TWDT não alimentado\n",
+                   TAG_WDT, slot->name, (now_us - slot->last_progress_us) / 1000);
+            fault_detected("liveness");
+            all_alive = false;
+        }
+    }
+    
+    if (all_alive && liveness_wdt_user != NULL && !fault_active(FAULT_WDT_STARVATION)) {
+        esp_task_wdt_reset_user(liveness_wdt_user);
+    }
+}
+
+#if LOW_POWER_ENABLED
+// Baixo consumo: o agente roda num esp_timer e o supervisor não acorda por ele
+static void liveness_timer_cb(void *arg) {
+    liveness_check_and_feed(esp_timer_get_time());
+}
+
+static bool liveness_timer_start(void) {
+    const esp_timer_create_args_t args = {
+        .callback = liveness_timer_cb,
+        .name = "liveness",
+    };
+    esp_timer_handle_t timer;
+    
+    if (esp_task_wdt_add_user("liveness", &liveness_wdt_user) != ESP_OK) {
+        return false;
+    }
+    return esp_timer_create(&args, &timer) == ESP_OK &&
+           esp_timer_start_periodic(timer, (uint64_t)LIVENESS_CHECK_PERIOD_MS * 1000) == ESP_OK;
+}
+#endif
+#endif
+
+/* ========== TIMEOUT ADAPTATIVO ========== */
+static void interarrival_reset(interarrival_estimator_t *est) {
+    est->mean_ms = (float)cfg_get(CFG_RECV_TIMEOUT_MS);
+    est->var_ms2 = 0.0f;
+    est->samples = 0;
+    est->last_arrival_us = 0;
+}
+
+// Registra uma chegada e atualiza média/variância exponenciais
+static void interarrival_update(interarrival_estimator_t *est, int64_t now_us) {
+    if (est->last_arrival_us != 0) {
+        float sample_ms = (float)(now_us - est->last_arrival_us) / 1000.0f;
+        
+        // Uma lacuna longa (falha) não deve inflar a estimativa além do limite
+        if (sample_ms > (float)cfg_get(CFG_RECV_TIMEOUT_MAX_MS)) {
+            sample_ms = (float)cfg_get(CFG_RECV_TIMEOUT_MAX_MS);
+        }
+        
+        if (est->samples == 0) {
+            est->mean_ms = sample_ms;
+            est->var_ms2 = 0.0f;
+        } else {
+            float diff = sample_ms - est->mean_ms;
+            est->mean_ms += INTERARRIVAL_ALPHA * diff;
+            est->var_ms2 = (1.0f - INTERARRIVAL_ALPHA) * (est->var_ms2 + INTERARRIVAL_ALPHA * diff * diff);
+        }
+        est->samples++;
+    }
+    est->last_arrival_us = now_us;
+}
+
+// Timeout de recepção derivado da distribuição observada, dentro dos limites
+static uint32_t interarrival_timeout_ms(const interarrival_estimator_t *est) {
+    // Sem amostras vale o recv_tmo, também limitado: os limites protegem o prazo de liveness
+    float timeout = (float)cfg_get(CFG_RECV_TIMEOUT_MS);
+    if (est->samples >= INTERARRIVAL_MIN_SAMPLES) {
+        timeout = est->mean_ms + RECV_TIMEOUT_K_SIGMA * sqrtf(est->var_ms2);
+        if (timeout < RECV_TIMEOUT_MEAN_MULT * est->mean_ms) {
+            timeout = RECV_TIMEOUT_MEAN_MULT * est->mean_ms;
+        }
+    }
+    
+    int32_t min_ms = cfg_get(CFG_RECV_TIMEOUT_MIN_MS);
+    int32_t max_ms = cfg_get(CFG_RECV_TIMEOUT_MAX_MS);
+    if (timeout < (float)min_ms) {
+        return (uint32_t)min_ms;
+    }
+    if (timeout > (float)max_ms) {
+        return (uint32_t)max_ms;
+    }
+    return (uint32_t)timeout;
+}
+
+/* ========== ENERGIA ========== */
+// Chamado pelo idle uma vez por interrupção que o acordou (retorno true)
+static bool idle_wakeup_hook(void) {
+    atomic_fetch_add_explicit(&idle_wakeups[xPortGetCoreID()], 1, memory_order_relaxed);
+    return true;
+}
+
+static bool power_init(void) {
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        if (esp_register_freertos_idle_hook_for_cpu(idle_wakeup_hook, core) != ESP_OK) {
+            return false;
+        }
+    }
+    
+#if LOW_POWER_ENABLED
+    // DFS + light sleep automático no tickless idle
+    const esp_pm_config_t pm_config = {
+        .max_freq_mhz = LOW_POWER_MAX_FREQ_MHZ,
+        .min_freq_mhz = LOW_POWER_MIN_FREQ_MHZ,
+        .light_sleep_enable = LOW_POWER_LIGHT_SLEEP,
+    };
+    if (esp_pm_configure(&pm_config) != ESP_OK) {
+        return false;
+    }
+#endif
+    return true;
+}
+
+// Despertares por segundo e fração do tempo no idle, por núcleo, desde o último relatório
+static void power_print(int64_t now_us) {
+    static uint32_t prev_wakeups[portNUM_PROCESSORS];
+    static int64_t prev_us = 0;
+#if configGENERATE_RUN_TIME_STATS
+    static uint32_t prev_idle[portNUM_PROCESSORS];
+    static uint32_t prev_total = 0;
+    uint32_t total = (uint32_t)portGET_RUN_TIME_COUNTER_VALUE();
+#endif
+    
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        uint32_t wakeups = atomic_load_explicit(&idle_wakeups[core], memory_order_relaxed);
+#if configGENERATE_RUN_TIME_STATS
+        uint32_t idle = (uint32_t)ulTaskGetIdleRunTimeCounterForCore(core);
+#endif
+        if (prev_us != 0 && now_us > prev_us) {
+            printf("%s Núcleo %d: %.1f despertares/s", TAG_SUP, core,
+                   (double)(wakeups - prev_wakeups[core]) * 1e6 / (double)(now_us - prev_us));
+#if configGENERATE_RUN_TIME_STATS
+            if (total != prev_total) {
+                printf(", %.1f%% ocioso", 100.0 * (double)(idle - prev_idle[core]) / (double)(total - prev_total));
+            }
+#endif
+            printf("%s\n", LOW_POWER_ENABLED ? " [baixo consumo]" : "");
+        }
+        prev_wakeups[core] = wakeups;
+#if configGENERATE_RUN_TIME_STATS
+        prev_idle[core] = idle;
+#endif
+    }
+#if configGENERATE_RUN_TIME_STATS
+    prev_total = total;
+#endif
+    prev_us = now_us;
+}
+
+/* ========== NOTIFICAÇÃO DO SUPERVISOR ========== */
+// Acorda o supervisor para reagir a uma transição sem esperar o próximo período
+static void supervisor_notify(uint32_t events) {
+    if (events & SUP_EVT_RECEIVER_SHUTDOWN) {
+        receiver_shutdown_signal_us = esp_timer_get_time();
+    }
+    
+#if SUPERVISOR_EVENT_DRIVEN
+    if (supervisor_task_handle != NULL) {
+        xTaskNotify(supervisor_task_handle, events, eSetBits);
+    }
+#endif
+}
+
+/* ========== FLAGS DE STATUS ========== */
+static int status_flag_index(EventBits_t bit) {
+    return __builtin_ctz((unsigned int)bit);
+}
+
+// Abre, contabiliza e fecha incidentes a partir de uma transição (com status_lock)
+static void incident_update(incident_tracker_t *tr, EventBits_t old_bits, EventBits_t new_bits, int64_t now_us) {
+    bool was_ok = (old_bits & tr->ok_bit) != 0;
+    bool is_ok = (new_bits & tr->ok_bit) != 0;
+    EventBits_t entered = new_bits & ~old_bits & tr->degraded_mask;
+    EventBits_t left = old_bits & ~new_bits & tr->degraded_mask;
+    
+    if (!tr->open && ((was_ok && !is_ok) || entered)) {
+        int64_t last_ok_us = status_times[status_flag_index(tr->ok_bit)].last_assert_us;
+        tr->open = true;
+        tr->onset_us = (last_ok_us != 0) ? last_ok_us : now_us;
+        tr->detect_us = now_us;
+        memset(tr->degraded_us, 0, sizeof(tr->degraded_us));
+    }
+    if (!tr->open) {
+        return;
+    }
+    
+    // Fim do OK: os estados ainda ativos contam até aqui
+    EventBits_t closing = (!was_ok && is_ok) ? (new_bits & tr->degraded_mask) : 0;
+    for (EventBits_t bits = left | closing; bits != 0; bits &= bits - 1) {
+        int i = status_flag_index(bits & -bits);
+        tr->degraded_us[i] += now_us - status_times[i].last_set_us;
+    }
+    
+    if (!was_ok && is_ok) {
+        uint32_t slot = tr->count % RELIABILITY_WINDOW;
+        tr->last_detect_us = tr->detect_us - tr->onset_us;
+        tr->last_ttr_us = now_us - tr->onset_us;
+        memcpy(tr->last_degraded_us, tr->degraded_us, sizeof(tr->degraded_us));
+        tr->ttr_us[slot] = tr->last_ttr_us;
+        tr->uptime_us[slot] = tr->onset_us - tr->last_recover_us;
+        tr->last_recover_us = now_us;
+        tr->count++;
+        tr->open = false;
+    }
+}
+
+// Chamado sob status_lock, na mesma seção que mudou o shadow: as transições
+// ficam registradas na ordem em que aconteceram
+static void status_record(EventBits_t old_bits, EventBits_t new_bits, EventBits_t asserted, int64_t now_us) {
+    EventBits_t changed = old_bits ^ new_bits;
+    
+    // Reafirmar um bit já ativo não é transição: só o timestamp
+    for (EventBits_t bits = asserted; bits != 0; bits &= bits - 1) {
+        status_times[status_flag_index(bits & -bits)].last_assert_us = now_us;
+    }
+    if (changed == 0) {
+        return;
+    }
+    
+    for (EventBits_t bits = changed; bits != 0; bits &= bits - 1) {
+        status_flag_times_t *times = &status_times[status_flag_index(bits & -bits)];
+        if (new_bits & bits & -bits) {
+            times->last_set_us = now_us;
+        } else {
+            times->last_clear_us = now_us;
+        }
+        times->transitions++;
+    }
+    incident_update(&receiver_incidents, old_bits, new_bits, now_us);
+    incident_update(&generator_incidents, old_bits, new_bits, now_us);
+}
+
+#if STATUS_PUBLISH_TRANSITIONS_ONLY
+// Copia o shadow para o Event Group. Se outro escritor mudou o shadow no
+// meio, copia de novo: quem escreve por último no kernel sempre relê o
+// valor mais novo, então o Event Group converge para o shadow. Liga antes
+// de desligar: um leitor entre as duas chamadas vê o estado novo somado ao
+// antigo, nunca um estado sem nenhum bit (DESCONHECIDO).
+static void status_publish(void) {
+    EventBits_t target = atomic_load_explicit(&status_shadow, memory_order_acquire);
+    for (;;) {
+        xEventGroupSetBits(status_flags, target);
+        xEventGroupClearBits(status_flags, ~target & STATUS_FLAG_MASK);
+        EventBits_t current = atomic_load_explicit(&status_shadow, memory_order_acquire);
+        if (current == target) {
+            return;
+        }
+        target = current;
+    }
+}
+#endif
+
+// Todas as mudanças de flags passam por aqui para terem as transições
+// registradas. Mudança do shadow e registro ficam numa só seção do
+// status_lock (dois escritores não registram fora de ordem); o Event Group
+// só é tocado depois, e só numa transição: sem ela, nenhuma chamada ao
+// kernel nem despertar de quem espera nos bits.
+static void status_update_bits(EventBits_t set, EventBits_t clear) {
+#if STATUS_MEASURE_OVERHEAD
+    uint32_t start = esp_cpu_get_cycle_count();
+#endif
+    taskENTER_CRITICAL(&status_lock);
+    int64_t now_us = esp_timer_get_time();    // Dentro da seção: tempos na ordem das transições
+    EventBits_t old_bits = atomic_load_explicit(&status_shadow, memory_order_relaxed);
+    EventBits_t new_bits = (old_bits & ~clear) | set;
+    if (new_bits != old_bits) {
+        atomic_store_explicit(&status_shadow, new_bits, memory_order_release);
+    }
+    status_record(old_bits, new_bits, set, now_us);
+    taskEXIT_CRITICAL(&status_lock);
+    
+#if STATUS_PUBLISH_TRANSITIONS_ONLY
+    bool published = (new_bits != old_bits);
+    if (published) {
+        status_publish();
+    }
+#else
+    bool published = true;
+    if (set) {
+        xEventGroupSetBits(status_flags, set);
+    }
+    if (clear & ~set) {
+        xEventGroupClearBits(status_flags, clear & ~set);
+    }
+#endif
+    
+#if STATUS_MEASURE_OVERHEAD
+    atomic_fetch_add_explicit(&status_cycles, esp_cpu_get_cycle_count() - start, memory_order_relaxed);
+    atomic_fetch_add_explicit(&status_updates, 1, memory_order_relaxed);
+    if (published) {
+        atomic_fetch_add_explicit(&status_publishes, 1, memory_order_relaxed);
+    }
+#else
+    (void)published;
+#endif
+}
+
+static inline void status_set_bits(EventBits_t bits) {
+    status_update_bits(bits, 0);
+}
+
+static inline void status_clear_bits(EventBits_t bits) {
+    status_update_bits(0, bits);
+}
+
+static int64_t incident_mean_us(const int64_t *window, uint32_t count) {
+    uint32_t n = (count < RELIABILITY_WINDOW) ? count : RELIABILITY_WINDOW;
+    int64_t sum = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        sum += window[i];
+    }
+    return n ? sum / n : 0;
+}
+
+// Verdadeiro se MTTR e MTBF móveis estão dentro das metas (sem incidentes = dentro)
+static bool incident_meets_targets(const incident_tracker_t *tr) {
+    return tr->count == 0 ||
+           (incident_mean_us(tr->ttr_us, tr->count) <= (int64_t)RELIABILITY_TARGET_MTTR_MS * 1000 &&
+            incident_mean_us(tr->uptime_us, tr->count) >= (int64_t)RELIABILITY_TARGET_MTBF_MS * 1000);
+}
+
+static void incident_print(const incident_tracker_t *tracker, int64_t now_us) {
+    incident_tracker_t tr;
+    taskENTER_CRITICAL(&status_lock);
+    tr = *tracker;
+    taskEXIT_CRITICAL(&status_lock);
+    
+    if (tr.open) {
+        printf("%s Incidente (%s) em andamento há %" PRId64 " ms\n",
+               TAG_SUP, tr.name, (now_us - tr.onset_us) / 1000);
+    }
+    if (tr.count == 0) {
+        return;
+    }
+    
+    printf("%s Confiabilidade (%s): %" PRIu32 " incidentes, MTTR %" PRId64 " ms, MTBF %" PRId64 " ms [%s]\n",
+           TAG_SUP, tr.name, tr.count, incident_mean_us(tr.ttr_us, tr.count) / 1000,
+           incident_mean_us(tr.uptime_us, tr.count) / 1000,
+           incident_meets_targets(&tr) ? "dentro das metas" : "FORA DAS METAS");
+    printf("%s Último incidente (%s): detecção %" PRId64 " ms, recuperação %" PRId64 " ms",
+           TAG_SUP, tr.name, tr.last_detect_us / 1000, tr.last_ttr_us / 1000);
+    if (tr.degraded_mask != 0) {
+        printf(" (aviso %" PRId64 " ms, recuperação %" PRId64 " ms, crítico %" PRId64 " ms)",
+               tr.last_degraded_us[status_flag_index(FLAG_RECEIVER_WARNING)] / 1000,
+               tr.last_degraded_us[status_flag_index(FLAG_RECEIVER_RECOVERY)] / 1000,
+               tr.last_degraded_us[status_flag_index(FLAG_RECEIVER_SHUTDOWN)] / 1000);
+    }
+    printf("\n");
+}
+
+/* ========== CRC32 ========== */
+/* crc32_tables[0] é a tabela clássica; crc32_tables[k] avança k bytes
+ * extras de zeros, o que permite consumir 8 bytes por iteração. Só existem
+ * as tabelas que a implementação escolhida lê: nenhuma com a da ROM, uma
+ * (1 KB) byte a byte e oito (8 KB) no slicing-by-8 ou no benchmark. */
+#if CRC_IMPL == CRC_IMPL_SLICE8 || CRC_BENCHMARK_ENABLED
+#define CRC32_TABLE_COUNT 8
+#elif CRC_IMPL == CRC_IMPL_BYTEWISE
+#define CRC32_TABLE_COUNT 1
+#else
+#define CRC32_TABLE_COUNT 0
+#endif
+
+#if CRC32_TABLE_COUNT > 0
+static uint32_t crc32_tables[CRC32_TABLE_COUNT][256];
+#endif
+
+// Gera as tabelas do CRC32 IEEE refletido (polinômio 0xEDB88320)
+static void crc32_init(void) {
+#if CRC32_TABLE_COUNT > 0
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ ((crc & 1u) ? 0xEDB88320u : 0u);
+        }
+        crc32_tables[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (int k = 1; k < CRC32_TABLE_COUNT; k++) {
+            uint32_t prev = crc32_tables[k - 1][i];
+            crc32_tables[k][i] = (prev >> 8) ^ crc32_tables[0][prev & 0xFFu];
+        }
+    }
+#endif
+}
+
+#if CRC_IMPL != CRC_IMPL_ROM || CRC_BENCHMARK_ENABLED
+// Atualiza um CRC (sem inversões) um byte por vez
+static uint32_t crc32_update_bytewise(uint32_t crc, const uint8_t *data, size_t len) {
+    while (len--) {
+        crc = (crc >> 8) ^ crc32_tables[0][(crc ^ *data++) & 0xFFu];
+    }
+    return crc;
+}
+#endif
+
+#if CRC_IMPL == CRC_IMPL_SLICE8 || CRC_BENCHMARK_ENABLED
+// Atualiza um CRC (sem inversões) oito bytes por vez; ESP32 é little-endian
+static uint32_t crc32_update_slice8(uint32_t crc, const uint8_t *data, size_t len) {
+    while (len >= 8) {
+        uint32_t one, two;
+        memcpy(&one, data, sizeof(one));
+        memcpy(&two, data + 4, sizeof(two));
+        one ^= crc;
+        crc = crc32_tables[7][one & 0xFFu] ^
+              crc32_tables[6][(one >> 8) & 0xFFu] ^
+              crc32_tables[5][(one >> 16) & 0xFFu] ^
+              crc32_tables[4][one >> 24] ^
+              crc32_tables[3][two & 0xFFu] ^
+              crc32_tables[2][(two >> 8) & 0xFFu] ^
+              crc32_tables[1][(two >> 16) & 0xFFu] ^
+              crc32_tables[0][two >> 24];
+        data += 8;
+        len -= 8;
+    }
+    return crc32_update_bytewise(crc, data, len);
+}
+#endif
+
+// CRC32 compatível com zlib.crc32 (valor inicial e XOR final 0xFFFFFFFF)
+static uint32_t crc32_compute(const void *data, size_t len) {
+#if CRC_IMPL == CRC_IMPL_ROM
+    return esp_rom_crc32_le(0, (const uint8_t *)data, (uint32_t)len);
+#elif CRC_IMPL == CRC_IMPL_SLICE8
+    return ~crc32_update_slice8(0xFFFFFFFFu, (const uint8_t *)data, len);
+#else
+    return ~crc32_update_bytewise(0xFFFFFFFFu, (const uint8_t *)data, len);
+#endif
+}
+
+// CRC de uma mensagem da fila (todos os campos antes de crc)
+static inline uint32_t data_msg_crc(const data_msg_t *msg) {
+    return crc32_compute(msg, offsetof(data_msg_t, crc));
+}
+
+/* ========== PROTOCOLO BINÁRIO ========== */
+static inline void put_u16_le(uint8_t *out, uint16_t v) {
+    out[0] = (uint8_t)v;
+    out[1] = (uint8_t)(v >> 8);
+}
+
+static inline void put_u32_le(uint8_t *out, uint32_t v) {
+    out[0] = (uint8_t)v;
+    out[1] = (uint8_t)(v >> 8);
+    out[2] = (uint8_t)(v >> 16);
+    out[3] = (uint8_t)(v >> 24);
+}
+
+#if TX_FORMAT == TX_FORMAT_BINARY && TX_CODEC == TX_CODEC_NONE
+// Empacota até WIRE_MAX_RECORDS valores em um quadro; retorna o tamanho
+static size_t wire_encode_frame(uint8_t *out, const int *values, uint32_t count) {
+    uint16_t payload_len = (uint16_t)(count * WIRE_RECORD_SIZE);
+    
+    out[0] = WIRE_SYNC_0;
+    out[1] = WIRE_SYNC_1;
+    put_u16_le(&out[2], payload_len);
+    put_u16_le(&out[4], (uint16_t)count);
+    for (uint32_t i = 0; i < count; i++) {
+        put_u32_le(&out[WIRE_HEADER_SIZE + i * WIRE_RECORD_SIZE], (uint32_t)values[i]);
+    }
+    
+    size_t crc_offset = WIRE_HEADER_SIZE + payload_len;
+    put_u32_le(&out[crc_offset], crc32_compute(&out[2], crc_offset - 2));
+    return crc_offset + WIRE_CRC_SIZE;
+}
+#endif
+
+/* ========== CODEC DELTA ========== */
+#if TX_FORMAT == TX_FORMAT_BINARY && TX_CODEC == TX_CODEC_DELTA
+typedef struct {
+    int32_t prev;               // Último valor codificado
+    int32_t last_delta;         // Delta repetido pelos tokens de run
+    uint8_t seq;                // Número de sequência do próximo quadro
+    uint32_t frames_since_key;
+} delta_codec_t;
+
+static inline uint32_t zigzag_encode(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static size_t varint_put(uint8_t *out, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = (uint8_t)(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = (uint8_t)v;
+    return n;
+}
+
+// Codifica o máximo de valores que cabe em um quadro; retorna o tamanho
+static size_t codec_encode_frame(delta_codec_t *codec, uint8_t *out,
+                                 const int *values, uint32_t count, uint32_t *consumed) {
+    const size_t limit = TX_FRAME_MTU - WIRE_CRC_SIZE;
+    bool keyframe = (codec->frames_since_key == 0);
+    
+    if (keyframe) {
+        codec->prev = 0;
+        codec->last_delta = 0;
+    }
+    
+    size_t p = WIRE_DELTA_HEADER_SIZE;
+    uint32_t run = 0;
+    uint32_t n = 0;
+    
+    // Reserva espaço para um literal e para fechar um run pendente
+    while (n < count && p + 2 * WIRE_VARINT_MAX <= limit) {
+        int32_t delta = (int32_t)((uint32_t)values[n] - (uint32_t)codec->prev);
+        if (delta == codec->last_delta) {
+            run++;
+        } else {
+            if (run > 0) {
+                p += varint_put(&out[p], ((uint64_t)run << 1) | 1u);
+                run = 0;
+            }
+            p += varint_put(&out[p], (uint64_t)zigzag_encode(delta) << 1);
+            codec->last_delta = delta;
+        }
+        codec->prev = values[n++];
+    }
+    if (run > 0) {
+        p += varint_put(&out[p], ((uint64_t)run << 1) | 1u);
+    }
+    
+    out[0] = WIRE_SYNC_0;
+    out[1] = WIRE_SYNC_1_DELTA;
+    put_u16_le(&out[2], (uint16_t)(p - WIRE_DELTA_HEADER_SIZE));
+    put_u16_le(&out[4], (uint16_t)n);
+    out[6] = codec->seq++;
+    out[7] = keyframe ? WIRE_FLAG_KEYFRAME : 0;
+    put_u32_le(&out[p], crc32_compute(&out[2], p - 2));
+    
+    codec->frames_since_key = (codec->frames_since_key + 1) % TX_CODEC_KEYFRAME_INTERVAL;
+    *consumed = n;
+    return p + WIRE_CRC_SIZE;
+}
+#endif
+
+/* ========== BUFFERS DE TRANSMISSÃO ========== */
+// Entrega o lote em preenchimento ao transmissor (nunca bloqueia)
+static void tx_flush(void) {
+    if (tx_fill_index < 0 || tx_batches[tx_fill_index].count == 0) {
+        return;
+    }
+    
+    uint8_t index = (uint8_t)tx_fill_index;
+    xQueueSend(tx_ready_queue, &index, 0);  // Capacidade = TX_NUM_BUFFERS, sempre cabe
+    tx_fill_index = -1;
+    
+    uint32_t in_use = TX_NUM_BUFFERS - (uint32_t)uxQueueMessagesWaiting(tx_free_queue);
+    if (in_use > tx_stats.peak_in_use) {
+        tx_stats.peak_in_use = in_use;
+    }
+}
+
+// Adiciona um valor ao lote atual; descarta se não houver buffer livre
+static bool tx_enqueue(int value) {
+    int64_t now_us = esp_timer_get_time();
+    
+    if (tx_fill_index < 0) {
+        uint8_t index;
+        if (xQueueReceive(tx_free_queue, &index, 0) != pdTRUE) {
+            // Transmissor atrasado: o receptor não espera, apenas contabiliza
+            if (tx_stall_start_us == 0) {
+                tx_stall_start_us = now_us;
+                fault_detected("stall da transmissão");
+            }
+            tx_stats.dropped++;
+            return false;
+        }
+        
+        if (tx_stall_start_us != 0) {
+            tx_stats.stall_us += (uint32_t)(now_us - tx_stall_start_us);
+            tx_stall_start_us = 0;
+        }
+        tx_fill_index = index;
+        tx_fill_start_us = now_us;
+        tx_batches[index].count = 0;
+    }
+    
+    tx_batch_t *batch = &tx_batches[tx_fill_index];
+    batch->values[batch->count++] = value;
+    
+    if (batch->count >= tx_batch_limit) {
+        tx_flush();
+    }
+    return true;
+}
+
+// Envia lotes parciais antigos para limitar a latência em taxas baixas
+static void tx_poll(void) {
+    if (tx_fill_index >= 0 &&
+        esp_timer_get_time() - tx_fill_start_us >= (int64_t)cfg_get(CFG_TX_FLUSH_MS) * 1000) {
+        tx_flush();
+    }
+}
+
+// Escreve bytes no sink configurado
+static void tx_sink_write(const void *data, size_t len) {
+    if (fault_active(FAULT_SLOW_CONSOLE)) {
+        // Falha injetada: sink que demora a aceitar os dados
+        vTaskDelay(pdMS_TO_TICKS(FAULT_SLOW_WRITE_MS));
+    }
+    
+#if TX_SINK == TX_SINK_UART
+    uart_write_bytes(TX_UART_NUM, data, len);
+#else
+    fwrite(data, 1, len, stdout);
+    fflush(stdout);
+#endif
+}
+
+static bool transmitter_init(void) {
+    tx_free_queue = xQueueCreate(TX_NUM_BUFFERS, sizeof(uint8_t));
+    tx_ready_queue = xQueueCreate(TX_NUM_BUFFERS, sizeof(uint8_t));
+    if (tx_free_queue == NULL || tx_ready_queue == NULL) {
+        return false;
+    }
+    
+    for (uint8_t i = 0; i < TX_NUM_BUFFERS; i++) {
+        xQueueSend(tx_free_queue, &i, 0);
+    }
+    
+#if TX_SINK == TX_SINK_UART
+    const uart_config_t uart_config = {
+        .baud_rate = TX_UART_BAUD,
+        .data_bits = UART_DATA_8_BITS,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk = UART_SCLK_DEFAULT,
+    };
+    if (uart_driver_install(TX_UART_NUM, 256, TX_UART_BUF_SIZE, 0, NULL, 0) != ESP_OK ||
+        uart_param_config(TX_UART_NUM, &uart_config) != ESP_OK ||
+        uart_set_pin(TX_UART_NUM, TX_UART_TX_PIN, TX_UART_RX_PIN,
+                     UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE) != ESP_OK) {
+        return false;
+    }
+#endif
+    return true;
+}
+
+/* ========== HISTOGRAMA DE LATÊNCIA ========== */
+// Em IRAM: também chamado pelos ganchos do escalonador
+static IRAM_ATTR void latency_hist_record(latency_hist_t *hist, uint32_t latency_us) {
+    int bucket = (latency_us > 1) ? 31 - __builtin_clz(latency_us) : 0;
+    if (bucket >= LAT_HIST_BUCKETS) {
+        bucket = LAT_HIST_BUCKETS - 1;
+    }
+    hist->buckets[bucket]++;
+    hist->count++;
+    if (latency_us > hist->max_us) {
+        hist->max_us = latency_us;
+    }
+}
+
+// Limite superior do bucket que contém o percentil pedido
+static uint32_t latency_hist_percentile(const latency_hist_t *hist, uint32_t percent) {
+    if (hist->count == 0) {
+        return 0;
+    }
+    
+    uint64_t target = ((uint64_t)hist->count * percent + 99) / 100;
+    uint64_t seen = 0;
+    for (int i = 0; i < LAT_HIST_BUCKETS; i++) {
+        seen += hist->buckets[i];
+        if (seen >= target) {
+            uint32_t upper = (i < 31) ? (1u << (i + 1)) : UINT32_MAX;
+            return (upper < hist->max_us) ? upper : hist->max_us;
+        }
+    }
+    return hist->max_us;
+}
+
+/* ========== TRANSPORTE ========== */
+// Resultado de um envio do produtor: ocupação máxima e recusas por falta de espaço
+static inline void xport_note_send(xport_stats_t *stats, uint32_t sent, uint32_t requested, uint32_t depth) {
+    if (sent < requested) {
+        stats->full++;
+    }
+    if (depth > stats->peak_depth) {
+        stats->peak_depth = depth;
+    }
+}
+
+/* Fila FreeRTOS: slots de tamanho fixo, bloqueio nativo nos dois lados */
+static inline bool xport_queue_create(xport_queue_t *x, uint32_t length) {
+    memset(&x->stats, 0, sizeof(x->stats));
+    x->stats.storage_bytes = length * sizeof(data_msg_t);
+    x->handle = xQueueCreate(length, sizeof(data_msg_t));
+    return x->handle != NULL;
+}
+
+static inline void xport_queue_destroy(xport_queue_t *x) {
+    vQueueDelete(x->handle);
+}
+
+static inline uint32_t xport_queue_depth(xport_queue_t *x) {
+    return (uint32_t)uxQueueMessagesWaitingFromISR(x->handle);
+}
+
+static inline bool xport_queue_send(xport_queue_t *x, const data_msg_t *msg, TickType_t timeout) {
+    bool ok = xQueueSend(x->handle, msg, timeout) == pdTRUE;
+    xport_note_send(&x->stats, ok, 1, xport_queue_depth(x));
+    return ok;
+}
+
+static inline bool xport_queue_send_from_isr(xport_queue_t *x, const data_msg_t *msg, BaseType_t *woken) {
+    bool ok = xQueueSendFromISR(x->handle, msg, woken) == pdTRUE;
+    xport_note_send(&x->stats, ok, 1, xport_queue_depth(x));
+    return ok;
+}
+
+static inline uint32_t xport_queue_send_batch(xport_queue_t *x, const data_msg_t *msgs, uint32_t count) {
+    uint32_t sent = 0;
+    while (sent < count && xQueueSend(x->handle, &msgs[sent], 0) == pdTRUE) {
+        sent++;
+    }
+    xport_note_send(&x->stats, sent, count, xport_queue_depth(x));
+    return sent;
+}
+
+static inline bool xport_queue_receive(xport_queue_t *x, data_msg_t *out) {
+    return xQueueReceive(x->handle, out, 0) == pdTRUE;
+}
+
+static inline uint32_t xport_queue_receive_batch(xport_queue_t *x, data_msg_t *out, uint32_t max) {
+    uint32_t received = 0;
+    while (received < max && xQueueReceive(x->handle, &out[received], 0) == pdTRUE) {
+        received++;
+    }
+    return received;
+}
+
+static inline void xport_queue_reset(xport_queue_t *x) {
+    xQueueReset(x->handle);
+}
+
+/* Message buffer: cada registro leva o prefixo de tamanho (size_t) */
+#define XPORT_MSGBUF_RECORD     (sizeof(data_msg_t) + sizeof(size_t))
+
+static inline bool xport_msgbuf_create(xport_msgbuf_t *x, uint32_t length) {
+    memset(&x->stats, 0, sizeof(x->stats));
+    x->capacity = length * XPORT_MSGBUF_RECORD;
+    x->stats.storage_bytes = (uint32_t)x->capacity;
+    x->handle = xMessageBufferCreate(x->capacity);
+    return x->handle != NULL;
+}
+
+static inline void xport_msgbuf_destroy(xport_msgbuf_t *x) {
+    vMessageBufferDelete(x->handle);
+}
+
+static inline uint32_t xport_msgbuf_depth(xport_msgbuf_t *x) {
+    // Registros de tamanho fixo: bytes ocupados / tamanho do registro
+    return (uint32_t)((x->capacity - xMessageBufferSpacesAvailable(x->handle)) / XPORT_MSGBUF_RECORD);
+}
+
+static inline bool xport_msgbuf_send(xport_msgbuf_t *x, const data_msg_t *msg, TickType_t timeout) {
+    bool ok = xMessageBufferSend(x->handle, msg, sizeof(*msg), timeout) == sizeof(*msg);
+    xport_note_send(&x->stats, ok, 1, xport_msgbuf_depth(x));
+    return ok;
+}
+
+static inline bool xport_msgbuf_send_from_isr(xport_msgbuf_t *x, const data_msg_t *msg, BaseType_t *woken) {
+    bool ok = xMessageBufferSendFromISR(x->handle, msg, sizeof(*msg), woken) == sizeof(*msg);
+    xport_note_send(&x->stats, ok, 1, xport_msgbuf_depth(x));
+    return ok;
+}
+
+static inline uint32_t xport_msgbuf_send_batch(xport_msgbuf_t *x, const data_msg_t *msgs, uint32_t count) {
+    uint32_t sent = 0;
+    while (sent < count && xMessageBufferSend(x->handle, &msgs[sent], sizeof(data_msg_t), 0) == sizeof(data_msg_t)) {
+        sent++;
+    }
+    xport_note_send(&x->stats, sent, count, xport_msgbuf_depth(x));
+    return sent;
+}
+
+static inline bool xport_msgbuf_receive(xport_msgbuf_t *x, data_msg_t *out) {
+    return xMessageBufferReceive(x->handle, out, sizeof(*out), 0) == sizeof(*out);
+}
+
+static inline uint32_t xport_msgbuf_receive_batch(xport_msgbuf_t *x, data_msg_t *out, uint32_t max) {
+    uint32_t received = 0;
+    while (received < max && xport_msgbuf_receive(x, &out[received])) {
+        received++;
+    }
+    return received;
+}
+
+static inline void xport_msgbuf_reset(xport_msgbuf_t *x) {
+    // Recusado com o produtor bloqueado no envio: o buffer fica como está
+    xMessageBufferReset(x->handle);
+}
+
+/* Stream buffer: registros de tamanho fixo sem prefixo; um lote é uma cópia
+ * só. O envio confere o espaço antes (escritor único), então nunca grava um
+ * registro pela metade; sem bloqueio nativo por registro inteiro, a espera
+ * do produtor é por polling a cada tick. */
+static inline bool xport_stream_create(xport_stream_t *x, uint32_t length) {
+    memset(&x->stats, 0, sizeof(x->stats));
+    x->capacity = length * sizeof(data_msg_t);
+    x->stats.storage_bytes = (uint32_t)x->capacity;
+    x->handle = xStreamBufferCreate(x->capacity, sizeof(data_msg_t));
+    return x->handle != NULL;
+}
+
+static inline void xport_stream_destroy(xport_stream_t *x) {
+    vStreamBufferDelete(x->handle);
+}
+
+static inline uint32_t xport_stream_depth(xport_stream_t *x) {
+    return (uint32_t)(xStreamBufferBytesAvailable(x->handle) / sizeof(data_msg_t));
+}
+
+static inline uint32_t xport_stream_push(xport_stream_t *x, const data_msg_t *msgs, uint32_t count) {
+    uint32_t room = (uint32_t)(xStreamBufferSpacesAvailable(x->handle) / sizeof(data_msg_t));
+    uint32_t n = (count < room) ? count : room;
+    if (n > 0) {
+        xStreamBufferSend(x->handle, msgs, n * sizeof(data_msg_t), 0);
+    }
+    return n;
+}
+
+static inline bool xport_stream_send(xport_stream_t *x, const data_msg_t *msg, TickType_t timeout) {
+    bool ok;
+    while (!(ok = xport_stream_push(x, msg, 1)) && timeout-- > 0) {
+        vTaskDelay(1);
+    }
+    xport_note_send(&x->stats, ok, 1, xport_stream_depth(x));
+    return ok;
+}
+
+static inline bool xport_stream_send_from_isr(xport_stream_t *x, const data_msg_t *msg, BaseType_t *woken) {
+    bool ok = xStreamBufferSpacesAvailable(x->handle) >= sizeof(*msg) &&
+              xStreamBufferSendFromISR(x->handle, msg, sizeof(*msg), woken) == sizeof(*msg);
+    xport_note_send(&x->stats, ok, 1, xport_stream_depth(x));
+    return ok;
+}
+
+static inline uint32_t xport_stream_send_batch(xport_stream_t *x, const data_msg_t *msgs, uint32_t count) {
+    uint32_t sent = xport_stream_push(x, msgs, count);
+    xport_note_send(&x->stats, sent, count, xport_stream_depth(x));
+    return sent;
+}
+
+static inline uint32_t xport_stream_receive_batch(xport_stream_t *x, data_msg_t *out, uint32_t max) {
+    return (uint32_t)(xStreamBufferReceive(x->handle, out, max * sizeof(data_msg_t), 0) / sizeof(data_msg_t));
+}
+
+static inline bool xport_stream_receive(xport_stream_t *x, data_msg_t *out) {
+    return xport_stream_receive_batch(x, out, 1) == 1;
+}
+
+static inline void xport_stream_reset(xport_stream_t *x) {
+    xStreamBufferReset(x->handle);
+}
+
+/* Anel SPSC: sem chamadas ao kernel nem seções críticas; o produtor publica
+ * com release em head e o consumidor libera slots com release em tail */
+static inline bool xport_spsc_create(xport_spsc_t *x, uint32_t length) {
+    memset(&x->stats, 0, sizeof(x->stats));
+    x->size = length + 1;
+    x->stats.storage_bytes = x->size * sizeof(data_msg_t);
+    atomic_init(&x->head, 0);
+    atomic_init(&x->tail, 0);
+    x->slots = malloc(x->stats.storage_bytes);
+    return x->slots != NULL;
+}
+
+static inline void xport_spsc_destroy(xport_spsc_t *x) {
+    free(x->slots);
+}
+
+static inline uint32_t xport_spsc_depth(xport_spsc_t *x) {
+    uint32_t head = atomic_load_explicit(&x->head, memory_order_acquire);
+    uint32_t tail = atomic_load_explicit(&x->tail, memory_order_acquire);
+    return (head + x->size - tail) % x->size;
+}
+
+static inline uint32_t xport_spsc_push(xport_spsc_t *x, const data_msg_t *msgs, uint32_t count) {
+    uint32_t head = atomic_load_explicit(&x->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&x->tail, memory_order_acquire);
+    uint32_t room = x->size - 1 - (head + x->size - tail) % x->size;
+    uint32_t n = (count < room) ? count : room;
+    
+    for (uint32_t i = 0; i < n; i++) {
+        x->slots[head] = msgs[i];
+        head = (head + 1 == x->size) ? 0 : head + 1;
+    }
+    atomic_store_explicit(&x->head, head, memory_order_release);
+    return n;
+}
+
+static inline bool xport_spsc_send(xport_spsc_t *x, const data_msg_t *msg, TickType_t timeout) {
+    bool ok;
+    while (!(ok = xport_spsc_push(x, msg, 1)) && timeout-- > 0) {
+        vTaskDelay(1);
+    }
+    xport_note_send(&x->stats, ok, 1, xport_spsc_depth(x));
+    return ok;
+}
+
+static inline bool xport_spsc_send_from_isr(xport_spsc_t *x, const data_msg_t *msg, BaseType_t *woken) {
+    bool ok = xport_spsc_push(x, msg, 1) == 1;
+    xport_note_send(&x->stats, ok, 1, xport_spsc_depth(x));
+    return ok;
+}
+
+static inline uint32_t xport_spsc_send_batch(xport_spsc_t *x, const data_msg_t *msgs, uint32_t count) {
+    uint32_t sent = xport_spsc_push(x, msgs, count);
+    xport_note_send(&x->stats, sent, count, xport_spsc_depth(x));
+    return sent;
+}
+
+static inline uint32_t xport_spsc_receive_batch(xport_spsc_t *x, data_msg_t *out, uint32_t max) {
+    uint32_t tail = atomic_load_explicit(&x->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&x->head, memory_order_acquire);
+    uint32_t received = 0;
+    
+    while (received < max && tail != head) {
+        out[received++] = x->slots[tail];
+        tail = (tail + 1 == x->size) ? 0 : tail + 1;
+    }
+    atomic_store_explicit(&x->tail, tail, memory_order_release);
+    return received;
+}
+
+static inline bool xport_spsc_receive(xport_spsc_t *x, data_msg_t *out) {
+    return xport_spsc_receive_batch(x, out, 1) == 1;
+}
+
+static inline void xport_spsc_reset(xport_spsc_t *x) {
+    atomic_store_explicit(&x->tail, atomic_load_explicit(&x->head, memory_order_acquire), memory_order_release);
+}
+
+/* Caixa postal: um slot (a capacidade pedida é ignorada). Com o slot cheio,
+ * o produtor dorme na própria notificação e o consumidor o acorda ao
+ * esvaziar. O handle do produtor só é entregue sob o lock, e quem apaga o
+ * produtor chama xport_notify_forget_writer() antes. */
+static inline bool xport_notify_create(xport_notify_t *x, uint32_t length) {
+    memset(x, 0, sizeof(*x));
+    x->stats.storage_bytes = sizeof(data_msg_t);
+    atomic_init(&x->full, false);
+    atomic_init(&x->notifying, false);
+    portMUX_INITIALIZE(&x->lock);
+    return true;
+}
+
+static inline void xport_notify_destroy(xport_notify_t *x) {
+}
+
+static inline uint32_t xport_notify_depth(xport_notify_t *x) {
+    return atomic_load_explicit(&x->full, memory_order_acquire) ? 1 : 0;
+}
+
+static inline bool xport_notify_push(xport_notify_t *x, const data_msg_t *msg) {
+    if (atomic_load_explicit(&x->full, memory_order_acquire)) {
+        return false;
+    }
+    x->slot = *msg;
+    atomic_store_explicit(&x->full, true, memory_order_release);
+    return true;
+}
+
+static inline void xport_notify_set_writer(xport_notify_t *x, TaskHandle_t writer) {
+    taskENTER_CRITICAL(&x->lock);
+    x->waiting_writer = writer;
+    taskEXIT_CRITICAL(&x->lock);
+}
+
+static inline bool xport_notify_send(xport_notify_t *x, const data_msg_t *msg, TickType_t timeout) {
+    bool ok = xport_notify_push(x, msg);
+    
+    while (!ok && timeout > 0) {
+        TickType_t start = xTaskGetTickCount();
+        xport_notify_set_writer(x, xTaskGetCurrentTaskHandle());
+        // Confere de novo: o consumidor pode ter esvaziado antes do registro
+        if (atomic_load_explicit(&x->full, memory_order_acquire)) {
+            ulTaskNotifyTake(pdTRUE, timeout);
+        }
+        xport_notify_set_writer(x, NULL);
+        
+        // Uma notificação antiga pode acordar antes da hora: desconta o tempo e tenta de novo
+        TickType_t waited = xTaskGetTickCount() - start;
+        timeout = (waited < timeout) ? timeout - waited : 0;
+        ok = xport_notify_push(x, msg);
+    }
+    xport_note_send(&x->stats, ok, 1, xport_notify_depth(x));
+    return ok;
+}
+
+static inline bool xport_notify_send_from_isr(xport_notify_t *x, const data_msg_t *msg, BaseType_t *woken) {
+    bool ok = xport_notify_push(x, msg);
+    xport_note_send(&x->stats, ok, 1, xport_notify_depth(x));
+    return ok;
+}
+
+static inline uint32_t xport_notify_send_batch(xport_notify_t *x, const data_msg_t *msgs, uint32_t count) {
+    uint32_t sent = (count > 0 && xport_notify_push(x, msgs)) ? 1 : 0;
+    xport_note_send(&x->stats, sent, count, xport_notify_depth(x));
+    return sent;
+}
+
+// Acorda o produtor em espera, se houver
+static inline void xport_notify_wake_writer(xport_notify_t *x) {
+    taskENTER_CRITICAL(&x->lock);
+    TaskHandle_t writer = x->waiting_writer;
+    x->waiting_writer = NULL;
+    if (writer != NULL) {
+        atomic_store_explicit(&x->notifying, true, memory_order_relaxed);
+    }
+    taskEXIT_CRITICAL(&x->lock);
+    
+    if (writer != NULL) {
+        xTaskNotifyGive(writer);
+        atomic_store_explicit(&x->notifying, false, memory_order_release);
+    }
+}
+
+// Antes de apagar o produtor: nenhuma notificação pendente ou em curso para ele
+static inline void xport_notify_forget_writer(xport_notify_t *x) {
+    xport_notify_set_writer(x, NULL);
+    while (atomic_load_explicit(&x->notifying, memory_order_acquire)) {
+        taskYIELD();
+    }
+}
+
+static inline bool xport_notify_receive(xport_notify_t *x, data_msg_t *out) {
+    if (!atomic_load_explicit(&x->full, memory_order_acquire)) {
+        return false;
+    }
+    *out = x->slot;
+    atomic_store_explicit(&x->full, false, memory_order_release);
+    xport_notify_wake_writer(x);
+    return true;
+}
+
+static inline uint32_t xport_notify_receive_batch(xport_notify_t *x, data_msg_t *out, uint32_t max) {
+    return (max > 0 && xport_notify_receive(x, out)) ? 1 : 0;
+}
+
+static inline void xport_notify_reset(xport_notify_t *x) {
+    atomic_store_explicit(&x->full, false, memory_order_release);
+    xport_notify_wake_writer(x);
+}
+
+/* ========== FAIXAS DE PRIORIDADE ========== */
+static bool lanes_init(void) {
+    int32_t urgent_len = cfg_get(CFG_URGENT_LENGTH);
+    int32_t bulk_len = cfg_get(CFG_QUEUE_LENGTH);
+    
+    lane_doorbell = xSemaphoreCreateCounting(urgent_len + bulk_len, 0);
+    return LANE_XPORT(create)(&lane_xports[LANE_URGENT], (uint32_t)urgent_len) &&
+           LANE_XPORT(create)(&lane_xports[LANE_BULK], (uint32_t)bulk_len) &&
+           lane_doorbell != NULL;
+}
+
+static inline lane_id_t lane_for_value(int32_t value) {
+    return (value % GEN_ALARM_INTERVAL == 0) ? LANE_URGENT : LANE_BULK;
+}
+
+// Mensagens na faixa (também chamado pelo handler de ISR do TWDT)
+static inline uint32_t lane_depth(int lane) {
+    return LANE_XPORT(depth)(&lane_xports[lane]);
+}
+
+// Retira uma mensagem da faixa sem esperar
+static inline bool lane_receive(int lane, data_msg_t *out) {
+    return LANE_XPORT(receive)(&lane_xports[lane], out);
+}
+
+// Enfileira na faixa declarada pela mensagem e toca a campainha do receptor
+static bool lane_send(const data_msg_t *msg, TickType_t timeout) {
+    if (!LANE_XPORT(send)(&lane_xports[msg->lane], msg, timeout)) {
+        return false;
+    }
+    lane_stats[msg->lane].sent++;
+    xSemaphoreGive(lane_doorbell);
+    return true;
+}
+
+#if GEN_SOURCE == GEN_SOURCE_TIMER
+// Versão de ISR: nunca espera; o chamador faz o yield conforme *woken
+static bool lane_send_from_isr(const data_msg_t *msg, BaseType_t *woken) {
+    if (!LANE_XPORT(send_from_isr)(&lane_xports[msg->lane], msg, woken)) {
+        return false;
+    }
+    lane_stats[msg->lane].sent++;
+    xSemaphoreGiveFromISR(lane_doorbell, woken);
+    return true;
+}
+#endif
+
+// Faixas mais altas primeiro; depois de lane_burst mensagens seguidas de uma
+// faixa alta, a faixa mais baixa com mensagens é servida (não passa fome)
+static bool lane_pop(data_msg_t *out) {
+    static uint32_t high_streak = 0;    // Só o receptor chama
+    
+    if (high_streak >= (uint32_t)cfg_get(CFG_LANE_BURST)) {
+        for (int lane = LANE_COUNT - 1; lane > LANE_URGENT; lane--) {
+            if (lane_receive(lane, out)) {
+                high_streak = 0;
+                return true;
+            }
+        }
+    }
+    for (int lane = 0; lane < LANE_COUNT; lane++) {
+        if (lane_receive(lane, out)) {
+            high_streak = (lane == LANE_URGENT) ? high_streak + 1 : 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Esvazia todas as faixas. As fichas ficam: cada uma já está no QueueSet do
+// receptor, que a descarta ao não achar mensagem. Como nunca há menos fichas
+// que mensagens, nenhuma mensagem fica sem campainha.
+static void lane_reset(void) {
+    for (int lane = 0; lane < LANE_COUNT; lane++) {
+        LANE_XPORT(reset)(&lane_xports[lane]);
+    }
+}
+
+static inline uint32_t lane_pending(void) {
+    uint32_t pending = 0;
+    for (int lane = 0; lane < LANE_COUNT; lane++) {
+        pending += lane_depth(lane);
+    }
+    return pending;
+}
+
+/* ========== CANAL DE CONTROLE ========== */
+static bool ctl_init(void) {
+    for (int task = 0; task < LIVENESS_TASK_COUNT; task++) {
+        ctl_queues[task] = xQueueCreate(CTL_QUEUE_LENGTH, sizeof(ctl_msg_t));
+        if (ctl_queues[task] == NULL) {
+            return false;
+        }
+    }
+    ctl_ack_queue = xQueueCreate(CTL_ACK_QUEUE_LENGTH, sizeof(ctl_ack_t));
+    return ctl_ack_queue != NULL;
+}
+
+// Enfileira um comando sem bloquear; retorna o número de sequência (0 = fila cheia)
+static uint16_t ctl_send(liveness_id_t task, ctl_cmd_t cmd, int32_t arg) {
+    uint16_t seq = (uint16_t)(atomic_fetch_add(&ctl_next_seq, 1) % UINT16_MAX + 1);
+    ctl_msg_t msg = { .cmd = (uint8_t)cmd, .seq = seq, .arg = arg, .sent_us = esp_timer_get_time() };
+    return (xQueueSend(ctl_queues[task], &msg, 0) == pdTRUE) ? seq : 0;
+}
+
+// Chamado pela tarefa depois de aplicar o comando
+static void ctl_ack(liveness_id_t task, const ctl_msg_t *msg, ctl_result_t result) {
+    ctl_ack_t ack = {
+        .task = (uint8_t)task, .cmd = msg->cmd, .result = (uint8_t)result, .seq = msg->seq,
+        .latency_us = (uint32_t)(esp_timer_get_time() - msg->sent_us),
+    };
+    if (xQueueSend(ctl_ack_queue, &ack, 0) == pdTRUE) {
+        supervisor_notify(SUP_EVT_CTL_ACK);
+    }
+}
+
+#if GEN_SOURCE == GEN_SOURCE_TASK && REPLAY_MODE != REPLAY_MODE_REPLAY
+/* Recuo de taxa do gerador: o supervisor envia o CTL_SET_RATE sem esperar e
+ * só adota o novo período quando o ack passa por ctl_record_ack() */
+static struct {
+    int32_t backoff_ms;         // Período confirmado (0 = gen_period da configuração)
+    int32_t pending_ms;
+    uint16_t pending_seq;       // 0 = nenhum comando em voo
+    TickType_t pending_since;
+} gen_rate;
+#endif
+
+static void ctl_record_ack(const ctl_ack_t *ack) {
+    if (ack->task >= LIVENESS_TASK_COUNT || ack->cmd >= CTL_COUNT || ack->result >= CTL_RESULT_COUNT) {
+        return;
+    }
+    
+#if GEN_SOURCE == GEN_SOURCE_TASK && REPLAY_MODE != REPLAY_MODE_REPLAY
+    if (gen_rate.pending_seq != 0 && ack->task == LIVENESS_GENERATOR && ack->seq == gen_rate.pending_seq) {
+        if (ack->result == CTL_OK) {
+            gen_rate.backoff_ms = gen_rate.pending_ms;
+        }
+        gen_rate.pending_seq = 0;
+    }
+#endif
+    
+    ctl_stats_t *stats = &ctl_stats[ack->cmd];
+    stats->acked++;
+    if (ack->result != CTL_OK) {
+        stats->failed++;
+    }
+    latency_hist_record(&stats->latency, ack->latency_us);
+    printf("%s ack %s/%s #%u: %s em %" PRIu32 " us\n", TAG_CTL, liveness_slots[ack->task].name,
+           ctl_names[ack->cmd], (unsigned int)ack->seq, ctl_result_names[ack->result], ack->latency_us);
+}
+
+// Registra as confirmações de comandos assíncronos (console)
+static void ctl_drain_acks(void) {
+    ctl_ack_t ack;
+    while (xQueueReceive(ctl_ack_queue, &ack, 0) == pdTRUE) {
+        ctl_record_ack(&ack);
+    }
+}
+
+// Envia e espera o ack (só o supervisor chama: é o único leitor das confirmações)
+static ctl_result_t ctl_call_timeout(liveness_id_t task, ctl_cmd_t cmd, int32_t arg, uint32_t timeout_ms) {
+    uint16_t seq = ctl_send(task, cmd, arg);
+    if (seq == 0) {
+        ctl_stats[cmd].timeouts++;
+        return CTL_TIMEOUT;
+    }
+    
+    TickType_t start = xTaskGetTickCount();
+    TickType_t timeout = pdMS_TO_TICKS(timeout_ms);
+    for (;;) {
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        ctl_ack_t ack;
+        if (xQueueReceive(ctl_ack_queue, &ack, (elapsed >= timeout) ? 0 : timeout - elapsed) != pdTRUE) {
+            ctl_stats[cmd].timeouts++;
+            printf("%s %s/%s #%u: sem resposta em %" PRIu32 " ms\n", TAG_CTL, liveness_slots[task].name,
+                   ctl_names[cmd], (unsigned int)seq, timeout_ms);
+            return CTL_TIMEOUT;
+        }
+        ctl_record_ack(&ack);
+        if (ack.task == task && ack.seq == seq) {
+            return (ctl_result_t)ack.result;
+        }
+    }
+}
+
+static inline ctl_result_t ctl_call(liveness_id_t task, ctl_cmd_t cmd, int32_t arg) {
+    return ctl_call_timeout(task, cmd, arg, CTL_ACK_TIMEOUT_MS);
+}
+
+/* ========== ESPERA DO RECEPTOR ========== */
+// O set comporta uma entrada por ficha possível e por comando pendente
+static bool rx_wait_init(void) {
+    int32_t doorbell_max = cfg_get(CFG_URGENT_LENGTH) + cfg_get(CFG_QUEUE_LENGTH);
+    
+    rx_wait_set = xQueueCreateSet(doorbell_max + CTL_QUEUE_LENGTH);
+    if (rx_wait_set == NULL) {
+        return false;
+    }
+    return xQueueAddToSet(lane_doorbell, rx_wait_set) == pdPASS &&
+           xQueueAddToSet(ctl_queues[LIVENESS_RECEIVER], rx_wait_set) == pdPASS;
+}
+
+// Bloqueia uma vez por dados ou comando. Um membro selecionado só é lido
+// depois do select, como exige o QueueSet; a ficha de uma faixa esvaziada
+// por lane_reset() não acha mensagem e a espera continua pelo restante do prazo.
+// Pausado, o receptor retira a ficha (mantendo o set coerente) mas deixa a
+// mensagem na faixa; rx_release_deferred() devolve as fichas na retomada.
+static rx_wait_result_t rx_wait(data_msg_t *out, ctl_msg_t *ctl, TickType_t timeout, bool paused) {
+    TickType_t start = xTaskGetTickCount();
+    
+    for (;;) {
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        QueueSetMemberHandle_t member = xQueueSelectFromSet(rx_wait_set,
+                                                            (elapsed >= timeout) ? 0 : timeout - elapsed);
+        if (member == NULL) {
+            return RX_WAIT_TIMEOUT;
+        }
+        if (member == ctl_queues[LIVENESS_RECEIVER]) {
+            if (xQueueReceive(ctl_queues[LIVENESS_RECEIVER], ctl, 0) == pdTRUE) {
+                return RX_WAIT_CTRL;
+            }
+        } else if (xSemaphoreTake(lane_doorbell, 0) == pdTRUE) {
+            if (paused) {
+                rx_deferred_tokens++;
+            } else if (lane_pop(out)) {
+                return RX_WAIT_DATA;
+            }
+        }
+    }
+}
+
+static void rx_release_deferred(void) {
+    for (; rx_deferred_tokens > 0; rx_deferred_tokens--) {
+        xSemaphoreGive(lane_doorbell);
+    }
+}
+
+/* ========== GRAVAÇÃO E REPLAY ========== */
+#if REPLAY_MODE == REPLAY_MODE_RECORD
+static replay_sample_t replay_samples[REPLAY_MAX_SAMPLES];
+static uint32_t replay_count = 0;
+static int64_t replay_last_us = 0;
+
+// Despeja as amostras em hexadecimal (tools/replay_tool.py extrai o arquivo)
+static void replay_dump(void) {
+    printf("REPLAY_BEGIN %" PRIu32 "\n", replay_count);
+    const uint8_t *bytes = (const uint8_t *)replay_samples;
+    size_t total = replay_count * sizeof(replay_sample_t);
+    for (size_t offset = 0; offset < total; offset += 128) {
+        printf("REPLAY_DATA ");
+        for (size_t i = offset; i < total && i < offset + 128; i++) {
+            printf("%02x", bytes[i]);
+        }
+        printf("\n");
+    }
+    printf("REPLAY_END\n");
+}
+
+// Registra um valor gerado e o intervalo desde o anterior
+static void replay_record(int32_t value) {
+    int64_t now_us = esp_timer_get_time();
+    replay_samples[replay_count].delta_us = replay_last_us ? (uint32_t)(now_us - replay_last_us) : 0;
+    replay_samples[replay_count].value = value;
+    replay_last_us = now_us;
+    
+    if (++replay_count == REPLAY_MAX_SAMPLES) {
+        replay_dump();
+        replay_count = 0;
+    }
+}
+#endif
+
+#if REPLAY_MODE == REPLAY_MODE_REPLAY
+#include "replay_stream.h"   // Gerado por tools/replay_tool.py: replay_stream[], REPLAY_STREAM_LEN
+
+// Alimenta o receptor com o fluxo gravado e mede a capacidade dele
+static void replay_run(void) {
+    data_msg_t msg = { 0 };
+    uint32_t lane_seq[LANE_COUNT] = { 0 };
+    uint32_t pass = 0;
+    
+    for (;;) {
+        uint32_t dropped = 0;
+        memset(&rx_latency, 0, sizeof(rx_latency));
+        int64_t start_us = esp_timer_get_time();
+#if REPLAY_SPEED == REPLAY_SPEED_RECORDED
+        int64_t due_us = start_us;
+#endif
+        
+        for (uint32_t i = 0; i < REPLAY_STREAM_LEN; i++) {
+#if REPLAY_SPEED == REPLAY_SPEED_RECORDED
+            // Reproduz o intervalo gravado (resolução de um tick)
+            due_us += replay_stream[i].delta_us;
+            int64_t wait_us = due_us - esp_timer_get_time();
+            if (wait_us > 0) {
+                vTaskDelay(pdMS_TO_TICKS(wait_us / 1000));
+            }
+#endif
+            msg.lane = lane_for_value(replay_stream[i].value);
+            msg.seq = ++lane_seq[msg.lane];
+            msg.value = replay_stream[i].value;
+            msg.sent_us = (uint32_t)esp_timer_get_time();
+            msg.crc = data_msg_crc(&msg);
+            
+#if REPLAY_SPEED == REPLAY_SPEED_MAX
+            // Bloqueia com a fila cheia: o ritmo passa a ser o do receptor
+            while (!lane_send(&msg, pdMS_TO_TICKS(REPLAY_SEND_TIMEOUT_MS))) {
+                task_alive(LIVENESS_GENERATOR);
+            }
+#else
+            if (!lane_send(&msg, 0)) {
+                lane_stats[msg.lane].dropped++;
+                dropped++;
+            }
+#endif
+            status_set_bits(FLAG_GENERATOR_OK);
+            heartbeat_beat(&generator_heartbeat);
+            task_alive(LIVENESS_GENERATOR);
+        }
+        
+        // Espera o receptor escoar a fila antes de medir
+        while (lane_pending() > 0) {
+            vTaskDelay(1);
+            heartbeat_beat(&generator_heartbeat);
+            task_alive(LIVENESS_GENERATOR);
+        }
+        int64_t elapsed_us = esp_timer_get_time() - start_us;
+        
+        printf("%s REPLAY %" PRIu32 " (%s): %d mensagens em %" PRId64 " ms -> %.1f msg/s, %" PRIu32 " descartadas\n",
+               TAG_GEN, ++pass, REPLAY_SPEED == REPLAY_SPEED_MAX ? "máxima" : "gravada",
+               REPLAY_STREAM_LEN, elapsed_us / 1000,
+               (double)REPLAY_STREAM_LEN * 1e6 / (double)(elapsed_us ? elapsed_us : 1), dropped);
+        printf("%s REPLAY latência: p50 %" PRIu32 " us, p99 %" PRIu32 " us, máx %" PRIu32 " us\n",
+               TAG_GEN, latency_hist_percentile(&rx_latency, 50),
+               latency_hist_percentile(&rx_latency, 99), rx_latency.max_us);
+        
+        vTaskDelay(pdMS_TO_TICKS(cfg_get(CFG_SUPERVISOR_PERIOD_MS)));
+    }
+}
+#endif
+
+/* ========== GRAVADOR DE TRACE ========== */
+#if TRACE_RECORDER_ENABLED
+/* Um ring por núcleo, escrito apenas pelo próprio núcleo com interrupções
+ * mascaradas. Cada janela grava até encher; o supervisor despeja em
+ * hexadecimal e rearma (tools/trace_to_chrome.py converte a saída). */
+typedef struct {
+    uint32_t timestamp_us;      // esp_timer, 32 bits baixos (o conversor desdobra)
+    uint8_t type;               // TRACE_EVT_*
+    uint8_t reserved;
+    uint16_t arg;               // Id de tarefa/objeto ou bits
+} trace_event_t;
+
+typedef struct {
+    trace_event_t events[TRACE_RING_EVENTS];
+    uint32_t count;
+    uint32_t dropped;
+    uint32_t cost_cycles;       // Ciclos gastos gravando (overhead por evento)
+} trace_ring_t;
+
+static DRAM_ATTR trace_ring_t trace_rings[portNUM_PROCESSORS];
+static DRAM_ATTR volatile bool trace_enabled = false;
+static DRAM_ATTR _Atomic(void *) trace_tasks[TRACE_MAX_TASKS];
+static DRAM_ATTR char trace_task_names[TRACE_MAX_TASKS][16];
+static DRAM_ATTR _Atomic(void *) trace_objects[TRACE_MAX_OBJECTS];
+static const char *trace_object_names[TRACE_MAX_OBJECTS];
+#endif
+
+#if TRACE_RECORDER_ENABLED || SCHED_STATS_ENABLED
+// Mapeia um handle para um índice pequeno, inserindo sem lock na 1a vez
+static IRAM_ATTR uint16_t trace_lookup(_Atomic(void *) *table, int size, void *handle, bool *inserted) {
+    for (int i = 0; i < size; i++) {
+        void *current = atomic_load_explicit(&table[i], memory_order_acquire);
+        if (current == handle) {
+            return (uint16_t)i;
+        }
+        if (current == NULL) {
+            void *expected = NULL;
+            if (atomic_compare_exchange_strong(&table[i], &expected, handle)) {
+                *inserted = true;
+                return (uint16_t)i;
+            }
+            if (expected == handle) {
+                return (uint16_t)i;
+            }
+        }
+    }
+    return TRACE_ID_UNKNOWN;
+}
+#endif
+
+#if TRACE_RECORDER_ENABLED
+
+static IRAM_ATTR uint16_t trace_task_id(TaskHandle_t task) {
+    bool inserted = false;
+    uint16_t id = trace_lookup(trace_tasks, TRACE_MAX_TASKS, task, &inserted);
+    if (inserted) {
+        // O nome é copiado enquanto a tarefa certamente existe
+        strncpy(trace_task_names[id], pcTaskGetName(task), sizeof(trace_task_names[id]) - 1);
+    }
+    return id;
+}
+
+static IRAM_ATTR uint16_t trace_object_id(void *object) {
+    bool inserted = false;
+    return trace_lookup(trace_objects, TRACE_MAX_OBJECTS, object, &inserted);
+}
+
+static IRAM_ATTR void trace_record(uint8_t type, uint16_t arg, uint32_t start_cycles) {
+    UBaseType_t irq_state = portSET_INTERRUPT_MASK_FROM_ISR();
+    trace_ring_t *ring = &trace_rings[xPortGetCoreID()];
+    
+    if (ring->count < TRACE_RING_EVENTS) {
+        trace_event_t *evt = &ring->events[ring->count++];
+        evt->timestamp_us = (uint32_t)esp_timer_get_time();
+        evt->type = type;
+        evt->reserved = 0;
+        evt->arg = arg;
+    } else {
+        ring->dropped++;
+    }
+    ring->cost_cycles += esp_cpu_get_cycle_count() - start_cycles;
+    
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(irq_state);
+}
+
+/* Ganchos chamados pelos macros trace* do kernel (ver trace_hooks.h) */
+void IRAM_ATTR trace_rec_task_switched_in(void) {
+    if (trace_enabled) {
+        uint32_t start = esp_cpu_get_cycle_count();
+        trace_record(TRACE_EVT_TASK_IN, trace_task_id(xTaskGetCurrentTaskHandle()), start);
+    }
+}
+
+void IRAM_ATTR trace_rec_task_switched_out(void) {
+    if (trace_enabled) {
+        uint32_t start = esp_cpu_get_cycle_count();
+        trace_record(TRACE_EVT_TASK_OUT, trace_task_id(xTaskGetCurrentTaskHandle()), start);
+    }
+}
+
+void IRAM_ATTR trace_rec_object_event(unsigned int type, void *object) {
+    if (trace_enabled) {
+        uint32_t start = esp_cpu_get_cycle_count();
+        trace_record((uint8_t)type, trace_object_id(object), start);
+    }
+}
+
+void IRAM_ATTR trace_rec_group_set_bits(void *group, unsigned int bits) {
+    if (trace_enabled) {
+        uint32_t start = esp_cpu_get_cycle_count();
+        trace_record(TRACE_EVT_GROUP_SET_BITS, (uint16_t)bits, start);
+    }
+}
+
+// Dá nome a uma fila/event group para a timeline
+static void trace_name_object(void *object, const char *name) {
+    bool inserted = false;
+    uint16_t id = trace_lookup(trace_objects, TRACE_MAX_OBJECTS, object, &inserted);
+    if (id != TRACE_ID_UNKNOWN) {
+        trace_object_names[id] = name;
+    }
+}
+
+static bool trace_window_full(void) {
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        if (trace_rings[core].count >= TRACE_RING_EVENTS) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Despeja a janela gravada no console e rearma o gravador
+static void trace_dump(void) {
+    trace_enabled = false;
+    vTaskDelay(1);  // Deixa terminar uma gravação em andamento no outro núcleo
+    
+    printf("TRACE_BEGIN %d\n", portNUM_PROCESSORS);
+    for (int i = 0; i < TRACE_MAX_TASKS; i++) {
+        if (atomic_load(&trace_tasks[i]) != NULL) {
+            printf("TRACE_TASK %d %s\n", i, trace_task_names[i]);
+        }
+    }
+    for (int i = 0; i < TRACE_MAX_OBJECTS; i++) {
+        if (atomic_load(&trace_objects[i]) != NULL) {
+            printf("TRACE_OBJ %d %s\n", i, trace_object_names[i] ? trace_object_names[i] : "?");
+        }
+    }
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        trace_ring_t *ring = &trace_rings[core];
+        const uint8_t *bytes = (const uint8_t *)ring->events;
+        size_t total = ring->count * sizeof(trace_event_t);
+        for (size_t offset = 0; offset < total; offset += 128) {
+            printf("TRACE_DATA %d ", core);
+            for (size_t i = offset; i < total && i < offset + 128; i++) {
+                printf("%02x", bytes[i]);
+            }
+            printf("\n");
+        }
+        printf("TRACE_STATS %d %" PRIu32 " %" PRIu32 " %" PRIu32 "\n",
+               core, ring->count, ring->dropped, ring->cost_cycles);
+        ring->count = 0;
+        ring->dropped = 0;
+        ring->cost_cycles = 0;
+    }
+    printf("TRACE_END\n");
+    
+    trace_enabled = true;
+}
+#endif
+
+/* ========== ESTATÍSTICAS DO ESCALONADOR ========== */
+#if SCHED_STATS_ENABLED
+/* Trocas de contexto por tarefa e latência entre ficar pronta (desbloqueada
+ * por uma fila, notificação ou delay) e voltar a rodar. Os contadores são
+ * escritos no núcleo da própria tarefa (as do pipeline são fixadas);
+ * ready_us pode ser marcado por outro núcleo ou por uma ISR. */
+typedef struct {
+    uint32_t voluntary;         // Saiu porque bloqueou
+    uint32_t involuntary;       // Saiu ainda pronta (preempção ou fatia de tempo)
+    atomic_uint ready_us;       // esp_timer quando ficou pronta (32 bits baixos | 1; 0 = nada pendente)
+    latency_hist_t wake_latency;
+} sched_task_stats_t;
+
+typedef struct {
+    void *out_task;             // Última tarefa que saiu neste núcleo
+    bool out_blocking;          // ...depois de anunciar que ia bloquear
+    bool blocking;              // A tarefa atual passou por um ponto de bloqueio
+} sched_core_t;
+
+static DRAM_ATTR _Atomic(void *) sched_tasks[SCHED_MAX_TASKS];
+static DRAM_ATTR char sched_task_names[SCHED_MAX_TASKS][16];
+static DRAM_ATTR sched_task_stats_t sched_stats[SCHED_MAX_TASKS];
+static DRAM_ATTR sched_core_t sched_cores[portNUM_PROCESSORS];
+
+static IRAM_ATTR sched_task_stats_t *sched_lookup(void *task) {
+    bool inserted = false;
+    uint16_t id = trace_lookup(sched_tasks, SCHED_MAX_TASKS, task, &inserted);
+    if (id == TRACE_ID_UNKNOWN) {
+        return NULL;
+    }
+    if (inserted) {
+        strncpy(sched_task_names[id], pcTaskGetName((TaskHandle_t)task), sizeof(sched_task_names[id]) - 1);
+    }
+    return &sched_stats[id];
+}
+
+/* Ganchos chamados pelos macros trace* do kernel (ver trace_hooks.h) */
+void IRAM_ATTR sched_rec_blocking(void) {
+    sched_cores[xPortGetCoreID()].blocking = true;
+}
+
+void IRAM_ATTR sched_rec_switched_out(void) {
+    sched_core_t *core = &sched_cores[xPortGetCoreID()];
+    core->out_task = xTaskGetCurrentTaskHandle();
+    core->out_blocking = core->blocking;
+    core->blocking = false;
+}
+
+void IRAM_ATTR sched_rec_switched_in(void) {
+    sched_core_t *core = &sched_cores[xPortGetCoreID()];
+    void *task = xTaskGetCurrentTaskHandle();
+    sched_task_stats_t *in = sched_lookup(task);
+    uint32_t ready_us = (in != NULL) ? atomic_exchange_explicit(&in->ready_us, 0, memory_order_relaxed) : 0;
+    
+    // A mesma tarefa escolhida de novo (ficou pronta antes de sair): não houve troca
+    if (task == core->out_task) {
+        return;
+    }
+    
+    sched_task_stats_t *out = (core->out_task != NULL) ? sched_lookup(core->out_task) : NULL;
+    if (out != NULL) {
+        if (core->out_blocking) {
+            out->voluntary++;
+        } else {
+            out->involuntary++;
+        }
+    }
+    if (ready_us != 0) {
+        latency_hist_record(&in->wake_latency, ((uint32_t)esp_timer_get_time() | 1u) - ready_us);
+    }
+}
+
+// Só a primeira marcação vale até a tarefa rodar
+void IRAM_ATTR sched_rec_ready(void *task) {
+    sched_task_stats_t *stats = sched_lookup(task);
+    if (stats != NULL) {
+        unsigned int expected = 0;
+        atomic_compare_exchange_strong_explicit(&stats->ready_us, &expected, (uint32_t)esp_timer_get_time() | 1u,
+                                                memory_order_relaxed, memory_order_relaxed);
+    }
+}
+
+// Trocas desde o último relatório e latência acumulada por tarefa
+static void sched_print(void) {
+    static uint32_t prev_voluntary[SCHED_MAX_TASKS];
+    static uint32_t prev_involuntary[SCHED_MAX_TASKS];
+    
+    for (int i = 0; i < SCHED_MAX_TASKS; i++) {
+        if (atomic_load(&sched_tasks[i]) == NULL) {
+            continue;
+        }
+        const sched_task_stats_t *stats = &sched_stats[i];
+        uint32_t voluntary = stats->voluntary;
+        uint32_t involuntary = stats->involuntary;
+        printf("%s Escalonador %-16s: %" PRIu32 " trocas voluntárias, %" PRIu32 " involuntárias; "
+               "pronta->rodando p50 %" PRIu32 " us, p99 %" PRIu32 " us, máx %" PRIu32 " us (%" PRIu32 ")\n",
+               TAG_SUP, sched_task_names[i], voluntary - prev_voluntary[i], involuntary - prev_involuntary[i],
+               latency_hist_percentile(&stats->wake_latency, 50), latency_hist_percentile(&stats->wake_latency, 99),
+               stats->wake_latency.max_us, stats->wake_latency.count);
+        prev_voluntary[i] = voluntary;
+        prev_involuntary[i] = involuntary;
+    }
+}
+#endif
+
+/* ========== MÓDULO 1: GERAÇÃO DE DADOS ========== */
+typedef struct {
+    bool paused;
+    int32_t period_ms;          // 0 = gen_period da configuração
+} generator_ctl_state_t;
+
+static ctl_result_t generator_apply_ctl(const ctl_msg_t *msg, generator_ctl_state_t *state) {
+    const cfg_param_t *period = &cfg_params[CFG_GENERATOR_PERIOD_MS];
+    
+    switch ((ctl_cmd_t)msg->cmd) {
+        case CTL_PAUSE:
+            state->paused = true;
+            return CTL_OK;
+        case CTL_RESUME:
+            state->paused = false;
+            return CTL_OK;
+        case CTL_SET_RATE:
+            // Mesmas regras do gen_period (live_gen, hb_stale): fora delas o
+            // gerador dormiria além do prazo de liveness
+            if (msg->arg != 0 && (msg->arg < period->min || msg->arg > period->max ||
+                                  cfg_check_with(CFG_GENERATOR_PERIOD_MS, msg->arg) != NULL)) {
+                return CTL_INVALID_ARG;
+            }
+            state->period_ms = msg->arg;
+            return CTL_OK;
+        case CTL_DRAIN:
+            // Nada fica retido no gerador
+            return CTL_OK;
+        case CTL_RESET_COUNTERS:
+            for (int lane = 0; lane < LANE_COUNT; lane++) {
+                lane_stats[lane].sent = 0;
+                lane_stats[lane].dropped = 0;
+            }
+            return CTL_OK;
+        default:
+            return CTL_UNSUPPORTED;
+    }
+}
+
+// Substitui o delay entre gerações: dorme o período atendendo comandos,
+// em fatias de meio prazo de liveness para sinalizar progresso mesmo com
+// período longo. Pausado, só sinaliza progresso a cada fatia.
+static void generator_wait(generator_ctl_state_t *state) {
+    TickType_t start = xTaskGetTickCount();
+    
+    for (;;) {
+        int32_t period_ms = state->period_ms ? state->period_ms : cfg_get(CFG_GENERATOR_PERIOD_MS);
+        TickType_t period = pdMS_TO_TICKS(period_ms);
+        TickType_t slice = pdMS_TO_TICKS(cfg_get(CFG_LIVENESS_GEN_MS) / 2);
+        TickType_t elapsed = xTaskGetTickCount() - start;
+        TickType_t wait = state->paused ? slice : ((elapsed >= period) ? 0 : period - elapsed);
+        if (wait > slice) {
+            wait = slice;
+        }
+        ctl_msg_t msg;
+        
+        if (xQueueReceive(ctl_queues[LIVENESS_GENERATOR], &msg, wait) != pdTRUE) {
+            if (!state->paused && xTaskGetTickCount() - start >= period) {
+                return;
+            }
+            // Fatia vencida: continua vivo para o agente de liveness e o TWDT
+            task_alive(LIVENESS_GENERATOR);
+            if (state->paused) {
+                heartbeat_beat(&generator_heartbeat);
+            }
+            continue;
+        }
+        
+        ctl_ack(LIVENESS_GENERATOR, &msg, generator_apply_ctl(&msg, state));
+        heartbeat_beat(&generator_heartbeat);
+    }
+}
+
+void task_data_generator(void *pvParameters) {
+    // Inscreve a tarefa no monitoramento de liveness/Watchdog
+    liveness_register(LIVENESS_GENERATOR);
+    
+    int sequential_value = 0;
+    data_msg_t msg = { 0 };
+    uint32_t lane_seq[LANE_COUNT] = { 0 };
+    generator_ctl_state_t ctl_state = { 0 };
+    
+    printf("%s Módulo de Geração iniciado\n", TAG_GEN);
+    
+#if REPLAY_MODE == REPLAY_MODE_REPLAY
+    // O fluxo gravado substitui a geração sequencial
+    replay_run();
+#endif
+    
+    for (;;) {
+        // Falha injetada: para sem produzir nem sinalizar progresso
+        while (fault_active(FAULT_GENERATOR_STALL)) {
+            vTaskDelay(pdMS_TO_TICKS(FAULT_POLL_MS));
+        }
+        
+        sequential_value++;
+#if REPLAY_MODE == REPLAY_MODE_RECORD
+        replay_record(sequential_value);
+#endif
+        
+        // Monta a mensagem protegida por CRC32; alarmes seguem pela faixa urgente
+        msg.lane = lane_for_value(sequential_value);
+        msg.seq = ++lane_seq[msg.lane];
+        msg.value = sequential_value;
+        msg.sent_us = (uint32_t)esp_timer_get_time();
+        msg.crc = data_msg_crc(&msg);
+        if (fault_active(FAULT_QUEUE_CORRUPT)) {
+            // Falha injetada: inverte um bit depois do CRC, como memória corrompida
+            msg.value ^= (int32_t)(1u << (msg.seq % 32));
+        }
+        
+        // Tenta enviar para a faixa sem bloquear
+        if (lane_send(&msg, pdMS_TO_TICKS(cfg_get(CFG_SEND_TIMEOUT_MS)))) {
+            printf("%s Dado enviado com sucesso!\n", TAG_QUEUE);
+            printf("%s Valor %d gerado e adicionado à fila\n", TAG_GEN, sequential_value);
+            
+            // Atualiza flag de status
+            status_set_bits(FLAG_GENERATOR_OK);
+            heartbeat_beat(&generator_heartbeat);
+        } else {
+            // Fila cheia - descarta valor mas continua funcionando
+            lane_stats[msg.lane].dropped++;
+            printf("%s Fila cheia! Dado descartado\n", TAG_QUEUE);
+            printf("%s AVISO: Valor %d descartado (fila lotada)\n", TAG_GEN, sequential_value);
+        }
+        
+        // Sinaliza progresso (alimenta o watchdog via agente de liveness)
+        task_alive(LIVENESS_GENERATOR);
+        
+        // Delay entre gerações (atendendo o canal de controle)
+        generator_wait(&ctl_state);
+    }
+}
+
+/* ========== GERADOR POR TIMER ========== */
+#if GEN_SOURCE == GEN_SOURCE_TIMER
+/* O alarme do gptimer substitui a tarefa do gerador: sem pilha própria e sem
+ * a troca de contexto por valor. O ISR não é IRAM-safe (padrão do driver),
+ * então fica adiado durante escritas na flash, como as do NVS. */
+typedef struct {
+    uint32_t count;
+    uint32_t cycles_total;      // Soma modular (a média usa a diferença entre relatórios)
+    uint32_t cycles_max;
+} gen_timer_stats_t;
+
+static gptimer_handle_t gen_timer = NULL;
+static int32_t gen_timer_value = 0;                 // Só o ISR escreve
+static uint32_t gen_timer_lane_seq[LANE_COUNT];     // ...idem
+static atomic_uint gen_timer_period_us;             // 0 = gen_period da configuração
+static gen_timer_stats_t gen_timer_stats;
+
+static inline uint32_t gen_timer_period(void) {
+    uint32_t period_us = atomic_load_explicit(&gen_timer_period_us, memory_order_relaxed);
+    return period_us ? period_us : (uint32_t)cfg_get(CFG_GENERATOR_PERIOD_MS) * 1000;
+}
+
+// Roda no daemon de timers: o Event Group e o registro de transições não têm versão de ISR
+static void gen_timer_set_ok(void *arg, uint32_t unused) {
+    status_set_bits(FLAG_GENERATOR_OK);
+}
+
+static bool gen_timer_on_alarm(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *ctx) {
+    uint32_t start = esp_cpu_get_cycle_count();
+    BaseType_t woken = pdFALSE;
+    
+    // Próximo alarme relativo ao anterior (sem deriva); se o ISR atrasou mais
+    // que um período, recomeça a partir da contagem atual
+    uint64_t next = edata->alarm_value + gen_timer_period();
+    if (next <= edata->count_value) {
+        next = edata->count_value + gen_timer_period();
+    }
+    gptimer_alarm_config_t alarm = { .alarm_count = next };
+    gptimer_set_alarm_action(timer, &alarm);
+    
+    // Falha injetada: para de produzir e de sinalizar progresso
+    if (!fault_active(FAULT_GENERATOR_STALL)) {
+        data_msg_t msg = { 0 };
+        gen_timer_value++;
+        msg.lane = lane_for_value(gen_timer_value);
+        msg.seq = ++gen_timer_lane_seq[msg.lane];
+        msg.value = gen_timer_value;
+        msg.sent_us = (uint32_t)esp_timer_get_time();
+        msg.crc = data_msg_crc(&msg);
+        if (fault_active(FAULT_QUEUE_CORRUPT)) {
+            msg.value ^= (int32_t)(1u << (msg.seq % 32));
+        }
+        
+        if (lane_send_from_isr(&msg, &woken)) {
+            heartbeat_beat(&generator_heartbeat);
+            if (!(atomic_load_explicit(&status_shadow, memory_order_relaxed) & FLAG_GENERATOR_OK)) {
+                // Só na transição para OK: adia para o daemon de timers
+                xTimerPendFunctionCallFromISR(gen_timer_set_ok, NULL, 0, &woken);
+            }
+        } else {
+            lane_stats[msg.lane].dropped++;
+        }
+    }
+    
+    uint32_t cycles = esp_cpu_get_cycle_count() - start;
+    gen_timer_stats.count++;
+    gen_timer_stats.cycles_total += cycles;
+    if (cycles > gen_timer_stats.cycles_max) {
+        gen_timer_stats.cycles_max = cycles;
+    }
+    return woken == pdTRUE;
+}
+
+static bool gen_timer_start(void) {
+    const gptimer_config_t config = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = GEN_TIMER_RESOLUTION_HZ,
+    };
+    const gptimer_event_callbacks_t callbacks = { .on_alarm = gen_timer_on_alarm };
+    const gptimer_alarm_config_t alarm = { .alarm_count = gen_timer_period() };
+    
+    return gptimer_new_timer(&config, &gen_timer) == ESP_OK &&
+           gptimer_register_event_callbacks(gen_timer, &callbacks, NULL) == ESP_OK &&
+           gptimer_enable(gen_timer) == ESP_OK &&
+           gptimer_set_alarm_action(gen_timer, &alarm) == ESP_OK &&
+           gptimer_start(gen_timer) == ESP_OK;
+}
+
+// Rearma o alarme a partir da contagem atual (recuperação pelo supervisor)
+static void gen_timer_restart(void) {
+    uint64_t count = 0;
+    
+    gptimer_stop(gen_timer);
+    gptimer_get_raw_count(gen_timer, &count);
+    gptimer_alarm_config_t alarm = { .alarm_count = count + gen_timer_period() };
+    gptimer_set_alarm_action(gen_timer, &alarm);
+    // Parado, o ISR não escreve: o supervisor pode renovar o heartbeat
+    heartbeat_beat(&generator_heartbeat);
+    gptimer_start(gen_timer);
+}
+
+// Custo do ISR desde o último relatório e período em uso
+static void gen_timer_print(void) {
+    static gen_timer_stats_t prev;
+    gen_timer_stats_t now = gen_timer_stats;
+    uint32_t count = now.count - prev.count;
+    uint32_t cpu_mhz = (uint32_t)esp_clk_cpu_freq() / 1000000;
+    
+    if (count > 0 && cpu_mhz > 0) {
+        uint32_t mean = (now.cycles_total - prev.cycles_total) / count;
+        printf("%s Gerador por timer: %" PRIu32 " alarmes, ISR média %" PRIu32 " ciclos (%.2f us), "
+               "máx %" PRIu32 " ciclos (%.2f us), período %" PRIu32 " us\n",
+               TAG_GEN, count, mean, (double)mean / cpu_mhz, now.cycles_max,
+               (double)now.cycles_max / cpu_mhz, gen_timer_period());
+    }
+    prev = now;
+}
+
+#if GEN_RATE_PROBE_ENABLED
+// Sonda de taxa: a cada relatório sem descartes (no envio ou na transmissão)
+// encurta o período em 25%; no primeiro com descartes, o último período
+// limpo é a taxa máxima sustentável e o gen_period volta a valer
+static void gen_rate_probe_step(void) {
+    static uint32_t dropped_prev = 0;
+    static uint32_t clean_period_us = 0;
+    static bool done = false;
+    
+    if (done) {
+        return;
+    }
+    
+    uint32_t dropped = tx_stats.dropped;
+    for (int lane = 0; lane < LANE_COUNT; lane++) {
+        dropped += lane_stats[lane].dropped;
+    }
+    uint32_t new_drops = dropped - dropped_prev;
+    dropped_prev = dropped;
+    
+    uint32_t period_us = gen_timer_period();
+    if (new_drops == 0 && period_us > GEN_RATE_PROBE_MIN_US) {
+        clean_period_us = period_us;
+        uint32_t next_us = period_us - period_us / 4;
+        if (next_us < GEN_RATE_PROBE_MIN_US) {
+            next_us = GEN_RATE_PROBE_MIN_US;
+        }
+        atomic_store_explicit(&gen_timer_period_us, next_us, memory_order_relaxed);
+        printf("%s Sonda: %.1f msg/s sem descartes, tentando %.1f msg/s\n",
+               TAG_GEN, 1e6 / period_us, 1e6 / next_us);
+        return;
+    }
+    
+    done = true;
+    atomic_store_explicit(&gen_timer_period_us, 0, memory_order_relaxed);
+    if (new_drops == 0) {
+        printf("%s Taxa máxima sustentável: acima de %.1f msg/s (limite da sonda)\n", TAG_GEN, 1e6 / period_us);
+    } else if (clean_period_us != 0) {
+        printf("%s Taxa máxima sustentável: %.1f msg/s (período %" PRIu32 " us; %" PRIu32 " descartes em %.1f msg/s)\n",
+               TAG_GEN, 1e6 / clean_period_us, clean_period_us, new_drops, 1e6 / period_us);
+    } else {
+        printf("%s Taxa máxima sustentável: abaixo de %.1f msg/s (descartes já no período inicial)\n",
+               TAG_GEN, 1e6 / period_us);
+    }
+}
+#endif
+#endif
+
+/* ========== MÓDULO 2: RECEPÇÃO DE DADOS ========== */
+// Sai do watchdog e avisa o supervisor antes de se encerrar
+static void receiver_exit(data_msg_t *msg) {
+    free(msg);
+    tx_flush();
+    liveness_unregister(LIVENESS_RECEIVER, NULL);
+    receiver_task_handle = NULL;
+    supervisor_notify(SUP_EVT_RECEIVER_SHUTDOWN);
+    vTaskDelete(NULL);
+}
+
+// Verifica a integridade e entrega ao estágio de transmissão
+static void receiver_deliver(const data_msg_t *msg, int64_t arrival_us) {
+    latency_hist_record(&rx_latency, (uint32_t)arrival_us - msg->sent_us);
+    
+    integrity_checked++;
+    if (data_msg_crc(msg) != msg->crc || msg->lane >= LANE_COUNT) {
+        integrity_errors++;
+        printf("%s ERRO: CRC inválido na mensagem %" PRIu32 ", descartada\n", TAG_RCV, msg->seq);
+        fault_detected("CRC");
+        return;
+    }
+    
+    // Lacunas na sequência da faixa são mensagens perdidas antes
+    // daqui (um gerador recriado recomeça em 1)
+    lane_stats_t *lane = &lane_stats[msg->lane];
+    uint32_t *last_seq = &rx_last_seq[msg->lane];
+    if (msg->seq > *last_seq + 1) {
+        rx_seq_gaps += msg->seq - *last_seq - 1;
+    }
+    *last_seq = msg->seq;
+    lane->received++;
+    latency_hist_record(&lane->latency, (uint32_t)arrival_us - msg->sent_us);
+    
+    // Entrega ao estágio de transmissão sem bloquear
+    if (tx_enqueue(msg->value)) {
+        fault_data_delivered();
+    } else {
+        printf("%s AVISO: Transmissor sem buffer livre, valor %" PRId32 " descartado\n",
+               TAG_TX, msg->value);
+    }
+}
+
+// Processa tudo que está nas faixas e escoa o lote parcial. As fichas ficam
+// para trás e são descartadas por rx_wait(), como depois de lane_reset().
+static uint32_t receiver_drain(data_msg_t *msg) {
+    uint32_t drained = 0;
+    while (lane_pop(msg)) {
+        receiver_deliver(msg, esp_timer_get_time());
+        drained++;
+    }
+    tx_flush();
+    return drained;
+}
+
+static ctl_result_t receiver_apply_ctl(const ctl_msg_t *ctl, bool *paused, data_msg_t *msg) {
+    switch ((ctl_cmd_t)ctl->cmd) {
+        case CTL_PAUSE:
+            *paused = true;
+            return CTL_OK;
+        case CTL_RESUME:
+            if (*paused) {
+                *paused = false;
+                rx_release_deferred();
+                // A pausa não é um intervalo entre chegadas
+                interarrival_reset(&rx_interarrival);
+            }
+            return CTL_OK;
+        case CTL_SET_BATCH:
+            if (ctl->arg < 1 || ctl->arg > TX_BATCH_SIZE) {
+                return CTL_INVALID_ARG;
+            }
+            tx_batch_limit = (uint32_t)ctl->arg;
+            if (tx_fill_index >= 0 && tx_batches[tx_fill_index].count >= tx_batch_limit) {
+                tx_flush();
+            }
+            return CTL_OK;
+        case CTL_DRAIN:
+            printf("%s Drenagem: %" PRIu32 " mensagens processadas\n", TAG_RCV, receiver_drain(msg));
+            return CTL_OK;
+        case CTL_RESET_COUNTERS:
+            integrity_checked = 0;
+            integrity_errors = 0;
+            rx_seq_gaps = 0;
+            memset(&rx_latency, 0, sizeof(rx_latency));
+            memset(&rx_wakeup_latency, 0, sizeof(rx_wakeup_latency));
+            for (int lane = 0; lane < LANE_COUNT; lane++) {
+                lane_stats[lane].received = 0;
+                memset(&lane_stats[lane].latency, 0, sizeof(lane_stats[lane].latency));
+            }
+            return CTL_OK;
+        case CTL_RESET_LANES:
+            lane_reset();
+            return CTL_OK;
+        case CTL_SHUTDOWN:
+            // Confirma antes: receiver_exit() não retorna
+            ctl_ack(LIVENESS_RECEIVER, ctl, CTL_OK);
+            printf("%s Finalizando módulo de recepção a pedido\n", TAG_RCV);
+            receiver_exit(msg);
+            return CTL_OK;
+        default:
+            return CTL_UNSUPPORTED;
+    }
+}
+
+void task_data_receiver(void *pvParameters) {
+    // Inscreve a tarefa no monitoramento de liveness/Watchdog
+    liveness_register(LIVENESS_RECEIVER);
+    
+    int timeout_count = 0;
+    int warning_count = 0;
+    int recovery_count = 0;
+    int shutdown_count = 0;
+    
+    bool paused = false;
+    
+    // Reinicia a estimativa a cada (re)criação da tarefa
+    interarrival_reset(&rx_interarrival);
+    // Fichas retidas por uma instância encerrada enquanto pausada
+    rx_release_deferred();
+    
+    printf("%s Módulo de Recepção iniciado\n", TAG_RCV);
+    
+    for (;;) {
+        // Falha injetada: trava sem sinalizar progresso até ser recriado
+        while (fault_active(FAULT_RECEIVER_HANG)) {
+            vTaskDelay(pdMS_TO_TICKS(FAULT_POLL_MS));
+        }
+        
+        // Aloca memória dinamicamente para armazenar a mensagem
+        // (a falha injetada simula heap esgotado)
+        data_msg_t *received_msg = fault_active(FAULT_MALLOC_FAIL) ? NULL :
+                                   (data_msg_t *)malloc(sizeof(data_msg_t));
+        
+        if (received_msg == NULL) {
+            printf("%s ERRO CRÍTICO: Falha na alocação de memória!\n", TAG_MEM);
+            fault_detected("malloc");
+            vTaskDelay(pdMS_TO_TICKS(100));
+            continue;
+        }
+        
+        // Espera dados ou um comando com timeout adaptativo. Os níveis de
+        // escalonamento contam timeouts, então também escalam com a taxa.
+        uint32_t recv_timeout_ms = paused ? CTL_PAUSED_WAIT_MS : interarrival_timeout_ms(&rx_interarrival);
+        bool idle = (lane_pending() == 0);
+        ctl_msg_t ctl;
+        rx_wait_result_t result = rx_wait(received_msg, &ctl, pdMS_TO_TICKS(recv_timeout_ms), paused);
+        if (result == RX_WAIT_CTRL) {
+            // Comando não conta como dado nem como timeout, mas é progresso
+            ctl_ack(LIVENESS_RECEIVER, &ctl, receiver_apply_ctl(&ctl, &paused, received_msg));
+            heartbeat_beat(&receiver_heartbeat);
+            
+        } else if (paused) {
+            // Pausado: sem escalonamento, só sinaliza que segue vivo
+            heartbeat_beat(&receiver_heartbeat);
+            
+        } else if (result == RX_WAIT_DATA) {
+            // Sucesso na recepção
+            int64_t arrival_us = esp_timer_get_time();
+            interarrival_update(&rx_interarrival, arrival_us);
+            if (idle) {
+                // Faixas vazias antes da espera: a latência é a do despertar
+                latency_hist_record(&rx_wakeup_latency, (uint32_t)arrival_us - received_msg->sent_us);
+            }
+            printf("%s Dado recebido da fila\n", TAG_QUEUE);
+            receiver_deliver(received_msg, arrival_us);
+            
+            // Reset dos contadores
+            timeout_count = 0;
+            warning_count = 0;
+            recovery_count = 0;
+            
+            // Atualiza flags (OK restaurado fecha o incidente); numa só
+            // atualização, que no caso comum não muda nada
+            status_update_bits(FLAG_RECEIVER_OK,
+                               FLAG_RECEIVER_WARNING | FLAG_RECEIVER_RECOVERY | FLAG_RECEIVER_SHUTDOWN);
+            
+            heartbeat_beat(&receiver_heartbeat);
+            
+        } else {
+            // Timeout - não recebeu dados; escoa o lote parcial
+            tx_flush();
+            timeout_count++;
+            
+            // Limiares lidos a cada timeout: podem mudar em tempo de execução
+            int max_warnings = (int)cfg_get(CFG_MAX_WARNINGS);
+            int max_recoveries = (int)cfg_get(CFG_MAX_RECOVERIES);
+            int max_shutdowns = (int)cfg_get(CFG_MAX_SHUTDOWNS);
+            printf("%s TIMEOUT: Nenhum dado recebido em %" PRIu32 " ms (tentativa %d)\n",
+                   TAG_RCV, recv_timeout_ms, timeout_count);
+            
+            // REAÇÃO ESCALONADA
+            if (timeout_count == 1 || timeout_count == max_warnings || timeout_count == max_recoveries) {
+                // Mudança de nível: o supervisor reage imediatamente
+                supervisor_notify(SUP_EVT_RECEIVER_ESCALATION);
+            }
+            fault_detected("timeout do receptor");
+            
+            // Cada nível troca os bits numa única transição (OK sai junto)
+            if (timeout_count >= 1 && timeout_count < max_warnings) {
+                // Nível 1: Avisos
+                warning_count++;
+                printf("%s [NIVEL 1 - AVISO %d/%d] Fila sem dados\n", TAG_RCV, warning_count, max_warnings);
+                status_update_bits(FLAG_RECEIVER_WARNING, FLAG_RECEIVER_OK);
+                
+            } else if (timeout_count >= max_warnings && timeout_count < max_recoveries) {
+                // Nível 2: Tentativa de recuperação
+                recovery_count++;
+                printf("%s [NIVEL 2 - RECUPERAÇÃO %d/%d] Resetando fila e limpando buffers\n", 
+                       TAG_RCV, recovery_count, max_recoveries);
+                lane_reset();
+                status_update_bits(FLAG_RECEIVER_RECOVERY, FLAG_RECEIVER_OK | FLAG_RECEIVER_WARNING);
+                
+            } else if (timeout_count >= max_recoveries && timeout_count < max_shutdowns) {
+                // Nível 3: Preparação para encerramento
+                shutdown_count++;
+                printf("%s [NIVEL 3 - CRÍTICO %d/%d] Preparando para encerramento\n", 
+                       TAG_RCV, shutdown_count, max_shutdowns);
+                status_update_bits(FLAG_RECEIVER_SHUTDOWN,
+                                   FLAG_RECEIVER_OK | FLAG_RECEIVER_WARNING | FLAG_RECEIVER_RECOVERY);
+                
+            } else {
+                // Nível 4: Encerramento da tarefa
+                printf("%s [NIVEL 4 - ENCERRAMENTO] Falha persistente detectada\n", TAG_RCV);
+                printf("%s Finalizando módulo de recepção\n", TAG_RCV);
+                status_update_bits(FLAG_RECEIVER_SHUTDOWN, FLAG_RECEIVER_OK);
+                receiver_exit(received_msg);
+                return;
+            }
+        }
+        
+        // Libera memória alocada
+        free(received_msg);
+        tx_poll();
+        
+        // Sinaliza progresso (alimenta o watchdog via agente de liveness)
+        task_alive(LIVENESS_RECEIVER);
+        
+#if !LOW_POWER_ENABLED
+        // Pequeno delay (no baixo consumo, seria um despertar a mais por mensagem)
+        vTaskDelay(pdMS_TO_TICKS(cfg_get(CFG_RECEIVER_DELAY_MS)));
+#endif
+    }
+}
+
+/* ========== MÓDULO 3: SUPERVISÃO ========== */
+static void supervisor_print_status(EventBits_t flags) {
+    printf("\n%s ========== STATUS DO SISTEMA ==========\n", TAG_SUP);
+    
+    // Status do Gerador
+    if (flags & FLAG_GENERATOR_OK) {
+        printf("%s Módulo Gerador: [OK] - Funcionando normalmente\n", TAG_SUP);
+    } else {
+        printf("%s Módulo Gerador: [FALHA] - Sem resposta\n", TAG_SUP);
+    }
+    
+    // Status do Receptor
+    if (flags & FLAG_RECEIVER_OK) {
+        printf("%s Módulo Receptor: [OK] - Recebendo dados\n", TAG_SUP);
+    } else if (flags & FLAG_RECEIVER_WARNING) {
+        printf("%s Módulo Receptor: [AVISO] - Timeouts detectados\n", TAG_SUP);
+    } else if (flags & FLAG_RECEIVER_RECOVERY) {
+        printf("%s Módulo Receptor: [RECUPERAÇÃO] - Tentando recuperar\n", TAG_SUP);
+    } else if (flags & FLAG_RECEIVER_SHUTDOWN) {
+        printf("%s Módulo Receptor: [CRÍTICO] - Em processo de encerramento\n", TAG_SUP);
+    } else {
+        printf("%s Módulo Receptor: [DESCONHECIDO] - Status indeterminado\n", TAG_SUP);
+    }
+    
+    // Estimativa de chegadas e timeout adaptativo em uso
+    printf("%s Intervalo entre chegadas: média %.1f ms, desvio %.1f ms -> timeout %" PRIu32 " ms\n",
+           TAG_RCV, (double)rx_interarrival.mean_ms, (double)sqrtf(rx_interarrival.var_ms2),
+           interarrival_timeout_ms(&rx_interarrival));
+    
+    // Idade e iterações dos heartbeats
+    int64_t now_us = esp_timer_get_time();
+    heartbeat_snapshot_t gen_hb = heartbeat_read(&generator_heartbeat);
+    heartbeat_snapshot_t rcv_hb = heartbeat_read(&receiver_heartbeat);
+    printf("%s Heartbeats: gerador %" PRId64 " ms (%" PRIu32 " iterações), receptor %" PRId64 " ms (%" PRIu32 " iterações)\n",
+           TAG_SUP, (now_us - (int64_t)gen_hb.timestamp_us) / 1000, gen_hb.iterations,
+           (now_us - (int64_t)rcv_hb.timestamp_us) / 1000, rcv_hb.iterations);
+    
+#if LIVENESS_MEASURE_OVERHEAD
+    // Custo médio do ponto de liveness por iteração do laço
+    for (int i = 0; i < LIVENESS_TASK_COUNT; i++) {
+        const liveness_slot_t *slot = &liveness_slots[i];
+        if (slot->overhead_calls > 0) {
+            printf("%s Custo por iteração (%s): %" PRIu32 " ciclos [%s]\n", TAG_WDT, slot->name,
+                   slot->overhead_cycles / slot->overhead_calls,
+                   LIVENESS_ENABLED ? "contador de liveness" : "esp_task_wdt_reset");
+        }
+    }
+#endif
+    
+#if STATUS_MEASURE_OVERHEAD
+    // Custo das atualizações de flags e quantas chegaram ao Event Group
+    uint32_t updates = atomic_load_explicit(&status_updates, memory_order_relaxed);
+    if (updates > 0) {
+        printf("%s Flags de status: %" PRIu32 " atualizações, %" PRIu32 " no Event Group, "
+               "%" PRIu32 " ciclos por atualização [%s]\n",
+               TAG_SUP, updates, atomic_load_explicit(&status_publishes, memory_order_relaxed),
+               atomic_load_explicit(&status_cycles, memory_order_relaxed) / updates,
+               STATUS_PUBLISH_TRANSITIONS_ONLY ? "só transições" : "toda atualização");
+    }
+#endif
+    
+    // Estágio de transmissão (taxas desde o último relatório)
+    static tx_stats_t tx_prev;
+    static int64_t tx_prev_us = 0;
+    tx_stats_t tx_now = tx_stats;
+    int64_t tx_elapsed_us = (tx_prev_us != 0) ? now_us - tx_prev_us : 0;
+    if (tx_elapsed_us > 0) {
+        uint32_t in_use = TX_NUM_BUFFERS - (uint32_t)uxQueueMessagesWaiting(tx_free_queue);
+        printf("%s Transmissão: %" PRIu64 " B/s, %" PRIu32 " lotes, %" PRIu32 " valores, buffers %" PRIu32 "/%d (pico %" PRIu32 ")\n",
+               TAG_TX, (uint64_t)(tx_now.bytes - tx_prev.bytes) * 1000000u / (uint64_t)tx_elapsed_us,
+               tx_now.batches - tx_prev.batches, tx_now.values - tx_prev.values,
+               in_use, TX_NUM_BUFFERS, tx_now.peak_in_use);
+        uint32_t values = tx_now.values - tx_prev.values;
+        if (values > 0) {
+            // Razão frente a registros int32 brutos e custo de codificação por valor
+            printf("%s Codificação: %.2f:1 sobre int32, %" PRIu32 " ciclos/valor\n", TAG_TX,
+                   (double)(values * WIRE_RECORD_SIZE) / (double)(tx_now.bytes - tx_prev.bytes),
+                   (tx_now.encode_cycles - tx_prev.encode_cycles) / values);
+        }
+        printf("%s Transmissão: %.1f B/valor, escrita %" PRIu32 " ms, stall %" PRIu32 " ms, %" PRIu32 " descartados\n",
+               TAG_TX, values ? (double)(tx_now.bytes - tx_prev.bytes) / values : 0.0,
+               (tx_now.write_us - tx_prev.write_us) / 1000,
+               (tx_now.stall_us - tx_prev.stall_us) / 1000, tx_now.dropped - tx_prev.dropped);
+    }
+    tx_prev = tx_now;
+    tx_prev_us = now_us;
+    
+    // Integridade das mensagens recebidas
+    printf("%s Integridade: %" PRIu32 " mensagens verificadas, %" PRIu32 " falhas de CRC, %" PRIu32 " perdidas na sequência\n",
+           TAG_RCV, integrity_checked, integrity_errors, rx_seq_gaps);
+    
+#if TRACE_RECORDER_ENABLED
+    // Ocupação da janela de trace e custo médio de gravação
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        const trace_ring_t *ring = &trace_rings[core];
+        printf("%s Trace núcleo %d: %" PRIu32 "/%d eventos, %" PRIu32 " descartados, %" PRIu32 " ciclos/evento\n",
+               TAG_SUP, core, ring->count, TRACE_RING_EVENTS, ring->dropped,
+               ring->count ? ring->cost_cycles / ring->count : 0);
+    }
+#endif
+    
+    // Latência fila (envio -> recepção)
+    printf("%s Latência da fila: p50 %" PRIu32 " us, p99 %" PRIu32 " us, máx %" PRIu32 " us (%" PRIu32 " amostras)\n",
+           TAG_RCV, latency_hist_percentile(&rx_latency, 50), latency_hist_percentile(&rx_latency, 99),
+           rx_latency.max_us, rx_latency.count);
+    printf("%s Despertar do receptor ocioso: p50 %" PRIu32 " us, p99 %" PRIu32 " us (%" PRIu32 " amostras)\n",
+           TAG_RCV, latency_hist_percentile(&rx_wakeup_latency, 50), latency_hist_percentile(&rx_wakeup_latency, 99),
+           rx_wakeup_latency.count);
+    
+    // Canal de controle: confirmações, falhas e latência envio -> aplicado
+    for (int i = 0; i < CTL_COUNT; i++) {
+        const ctl_stats_t *stats = &ctl_stats[i];
+        if (stats->acked + stats->timeouts > 0) {
+            printf("%s Comando %s: %" PRIu32 " acks (%" PRIu32 " com erro), %" PRIu32 " sem resposta, "
+                   "latência p50 %" PRIu32 " us, p99 %" PRIu32 " us, máx %" PRIu32 " us\n",
+                   TAG_CTL, ctl_names[i], stats->acked, stats->failed, stats->timeouts,
+                   latency_hist_percentile(&stats->latency, 50), latency_hist_percentile(&stats->latency, 99),
+                   stats->latency.max_us);
+        }
+    }
+    
+    // Incidentes: detecção, tempo até recuperar e MTTR/MTBF móveis
+    incident_print(&receiver_incidents, now_us);
+    incident_print(&generator_incidents, now_us);
+    
+    // Faixas: ocupação, descartes e latência por prioridade
+    for (int i = 0; i < LANE_COUNT; i++) {
+        const lane_stats_t *lane = &lane_stats[i];
+        printf("%s Faixa %s: %" PRIu32 " enviadas, %" PRIu32 " descartadas, %" PRIu32 " recebidas, fila %u "
+               "(pico %" PRIu32 "), latência p50 %" PRIu32 " us, p99 %" PRIu32 " us, máx %" PRIu32 " us\n",
+               TAG_QUEUE, lane_names[i], lane->sent, lane->dropped, lane->received,
+               (unsigned int)lane_depth(i), lane_xports[i].stats.peak_depth,
+               latency_hist_percentile(&lane->latency, 50), latency_hist_percentile(&lane->latency, 99),
+               lane->latency.max_us);
+    }
+    
+    // Latência entre a falha do receptor e a ação de recuperação
+    if (fault_action_count > 0) {
+        printf("%s Latência falha->ação: última %" PRId64 " us, máxima %" PRId64 " us (%" PRIu32 " ações)\n",
+               TAG_SUP, fault_action_last_us, fault_action_max_us, fault_action_count);
+    }
+    
+#if GEN_SOURCE == GEN_SOURCE_TIMER
+    // Custo do ISR do gerador
+    gen_timer_print();
+#endif
+    
+    // Despertares e ociosidade por núcleo
+    power_print(now_us);
+    
+#if SCHED_STATS_ENABLED
+    // Preempções por tarefa e latência de despertar no escalonador
+    sched_print();
+#endif
+    
+    // Informações de memória
+    size_t free_heap = xPortGetFreeHeapSize();
+    size_t min_heap = xPortGetMinimumEverFreeHeapSize();
+    printf("%s Memória livre: %u bytes (mínimo histórico: %u bytes)\n", 
+           TAG_MEM, (unsigned int)free_heap, (unsigned int)min_heap);
+    
+    printf("%s ========================================\n\n", TAG_SUP);
+}
+
+#if STATUS_REPORT == STATUS_REPORT_JSON
+/* Registro de status em uma linha JSON: contadores acumulados, estados e
+ * deltas desde o registro anterior (não desde o último período). A linha é
+ * montada inteira antes de ir ao console, para não se misturar com logs. */
+typedef struct {
+    char buf[STATUS_JSON_MAX];
+    size_t len;
+} json_line_t;
+
+static void json_append(json_line_t *line, const char *fmt, ...) {
+    if (line->len >= sizeof(line->buf)) {
+        return;
+    }
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(line->buf + line->len, sizeof(line->buf) - line->len, fmt, args);
+    va_end(args);
+    if (n > 0) {
+        line->len += (size_t)n;
+    }
+}
+
+// Contadores zerados por CTL_RESET_COUNTERS recomeçam do zero
+static inline uint32_t counter_delta(uint32_t now, uint32_t prev) {
+    return (now >= prev) ? now - prev : now;
+}
+
+typedef struct {
+    uint32_t received;
+    uint32_t sent;
+    uint32_t dropped;
+    uint32_t tx_dropped;
+    uint32_t tx_bytes;
+    uint32_t crc_errors;
+    uint32_t gaps;
+    uint32_t incidents;
+    uint32_t ctl_failures;
+} status_counters_t;
+
+static status_counters_t status_counters_read(void) {
+    status_counters_t c = {
+        .tx_dropped = tx_stats.dropped,
+        .tx_bytes = tx_stats.bytes,
+        .crc_errors = integrity_errors,
+        .gaps = rx_seq_gaps,
+    };
+    for (int i = 0; i < LANE_COUNT; i++) {
+        c.received += lane_stats[i].received;
+        c.sent += lane_stats[i].sent;
+        c.dropped += lane_stats[i].dropped;
+    }
+    for (int i = 0; i < CTL_COUNT; i++) {
+        c.ctl_failures += ctl_stats[i].failed + ctl_stats[i].timeouts;
+    }
+    taskENTER_CRITICAL(&status_lock);
+    c.incidents = receiver_incidents.count + generator_incidents.count +
+                  receiver_incidents.open + generator_incidents.open;
+    taskEXIT_CRITICAL(&status_lock);
+    return c;
+}
+
+static const char *status_receiver_state(EventBits_t flags) {
+    if (flags & FLAG_RECEIVER_OK) {
+        return "ok";
+    } else if (flags & FLAG_RECEIVER_WARNING) {
+        return "aviso";
+    } else if (flags & FLAG_RECEIVER_RECOVERY) {
+        return "recuperacao";
+    } else if (flags & FLAG_RECEIVER_SHUTDOWN) {
+        return "critico";
+    }
+    return "desconhecido";
+}
+
+// Emite um registro se algo mudou (flags, perdas, erros, incidentes) ou se o
+// heartbeat venceu; com STATUS_JSON_ON_CHANGE 0, a cada chamada
+static void supervisor_emit_status(EventBits_t flags, int64_t now_us, bool escalation) {
+    static json_line_t line;
+    static status_counters_t prev;
+    static EventBits_t prev_flags;
+    static int64_t prev_us = 0;
+    static uint32_t seq = 0;
+    
+    status_counters_t now = status_counters_read();
+    status_counters_t d = {
+        .received = counter_delta(now.received, prev.received),
+        .sent = counter_delta(now.sent, prev.sent),
+        .dropped = counter_delta(now.dropped, prev.dropped),
+        .tx_dropped = counter_delta(now.tx_dropped, prev.tx_dropped),
+        .tx_bytes = now.tx_bytes - prev.tx_bytes,   // Modular: só cresce
+        .crc_errors = counter_delta(now.crc_errors, prev.crc_errors),
+        .gaps = counter_delta(now.gaps, prev.gaps),
+        .incidents = counter_delta(now.incidents, prev.incidents),
+        .ctl_failures = counter_delta(now.ctl_failures, prev.ctl_failures),
+    };
+    
+    const char *why = "periodico";
+    if (prev_us == 0) {
+        why = "boot";
+    } else if (escalation || flags != prev_flags || d.dropped || d.tx_dropped || d.crc_errors ||
+               d.gaps || d.incidents || d.ctl_failures) {
+        why = "mudanca";
+    } else if (now_us - prev_us >= (int64_t)STATUS_JSON_HEARTBEAT_MS * 1000) {
+        why = "heartbeat";
+    } else if (STATUS_JSON_ON_CHANGE) {
+        return;
+    }
+    
+    heartbeat_snapshot_t gen_hb = heartbeat_read(&generator_heartbeat);
+    heartbeat_snapshot_t rcv_hb = heartbeat_read(&receiver_heartbeat);
+    
+    line.len = 0;
+    json_append(&line, "{\"rec\":\"status\",\"v\":1,\"seq\":%" PRIu32 ",\"t_ms\":%" PRId64
+                ",\"dt_ms\":%" PRId64 ",\"why\":\"%s\"",
+                seq++, now_us / 1000, prev_us ? (now_us - prev_us) / 1000 : 0, why);
+    json_append(&line, ",\"flags\":%u,\"gen\":\"%s\",\"rcv\":\"%s\"", (unsigned int)flags,
+                (flags & FLAG_GENERATOR_OK) ? "ok" : "falha", status_receiver_state(flags));
+    json_append(&line, ",\"hb_ms\":[%" PRId64 ",%" PRId64 "]",
+                (now_us - (int64_t)gen_hb.timestamp_us) / 1000, (now_us - (int64_t)rcv_hb.timestamp_us) / 1000);
+    json_append(&line, ",\"rx\":{\"checked\":%" PRIu32 ",\"crc_err\":%" PRIu32 ",\"gaps\":%" PRIu32
+                ",\"p50_us\":%" PRIu32 ",\"p99_us\":%" PRIu32 ",\"max_us\":%" PRIu32
+                ",\"wake_p99_us\":%" PRIu32 ",\"timeout_ms\":%" PRIu32 "}",
+                integrity_checked, integrity_errors, rx_seq_gaps,
+                latency_hist_percentile(&rx_latency, 50), latency_hist_percentile(&rx_latency, 99),
+                rx_latency.max_us, latency_hist_percentile(&rx_wakeup_latency, 99),
+                interarrival_timeout_ms(&rx_interarrival));
+    
+    json_append(&line, ",\"lanes\":[");
+    for (int i = 0; i < LANE_COUNT; i++) {
+        const lane_stats_t *lane = &lane_stats[i];
+        json_append(&line, "%s{\"name\":\"%s\",\"sent\":%" PRIu32 ",\"drop\":%" PRIu32 ",\"recv\":%" PRIu32
+                    ",\"depth\":%" PRIu32 ",\"peak\":%" PRIu32 ",\"p99_us\":%" PRIu32 "}",
+                    i ? "," : "", lane_names[i], lane->sent, lane->dropped, lane->received,
+                    lane_depth(i), lane_xports[i].stats.peak_depth, latency_hist_percentile(&lane->latency, 99));
+    }
+    json_append(&line, "]");
+    
+    tx_stats_t tx = tx_stats;
+    json_append(&line, ",\"tx\":{\"bytes\":%" PRIu32 ",\"values\":%" PRIu32 ",\"batches\":%" PRIu32
+                ",\"dropped\":%" PRIu32 ",\"stall_ms\":%" PRIu32 ",\"write_ms\":%" PRIu32 "}",
+                tx.bytes, tx.values, tx.batches, tx.dropped, tx.stall_us / 1000, tx.write_us / 1000);
+    
+    json_append(&line, ",\"inc\":[");
+    const incident_tracker_t *trackers[] = { &receiver_incidents, &generator_incidents };
+    for (size_t i = 0; i < sizeof(trackers) / sizeof(trackers[0]); i++) {
+        incident_tracker_t tr;
+        taskENTER_CRITICAL(&status_lock);
+        tr = *trackers[i];
+        taskEXIT_CRITICAL(&status_lock);
+        json_append(&line, "%s{\"name\":\"%s\",\"open\":%s,\"count\":%" PRIu32 ",\"mttr_ms\":%" PRId64
+                    ",\"mtbf_ms\":%" PRId64 "}",
+                    i ? "," : "", tr.name, tr.open ? "true" : "false", tr.count,
+                    incident_mean_us(tr.ttr_us, tr.count) / 1000, incident_mean_us(tr.uptime_us, tr.count) / 1000);
+    }
+    json_append(&line, "]");
+    
+    json_append(&line, ",\"heap\":[%u,%u]", (unsigned int)xPortGetFreeHeapSize(),
+                (unsigned int)xPortGetMinimumEverFreeHeapSize());
+    json_append(&line, ",\"d\":{\"recv\":%" PRIu32 ",\"sent\":%" PRIu32 ",\"drop\":%" PRIu32
+                ",\"tx_drop\":%" PRIu32 ",\"tx_bytes\":%" PRIu32 ",\"crc_err\":%" PRIu32 ",\"gaps\":%" PRIu32
+                ",\"inc\":%" PRIu32 ",\"ctl_fail\":%" PRIu32 "}}",
+                d.received, d.sent, d.dropped, d.tx_dropped, d.tx_bytes, d.crc_errors, d.gaps,
+                d.incidents, d.ctl_failures);
+    
+    if (line.len >= sizeof(line.buf)) {
+        // Mantém o instantâneo anterior: os deltas seguem no próximo registro
+        printf("%s AVISO: Registro de status maior que %d bytes, descartado\n", TAG_SUP, STATUS_JSON_MAX);
+        return;
+    }
+    printf("%s\n", line.buf);
+    
+    prev = now;
+    prev_flags = flags;
+    prev_us = now_us;
+}
+#endif
+
+#if GEN_SOURCE == GEN_SOURCE_TASK && REPLAY_MODE != REPLAY_MODE_REPLAY
+// Descartes no envio indicam um receptor mais lento que o gerador: dobra o
+// período do gerador pelo canal de controle e volta aos poucos quando param.
+// Não bloqueia: o ack chega por ctl_drain_acks() no laço do supervisor.
+static void supervisor_adjust_generator_rate(void) {
+    static uint32_t dropped_prev = 0;
+    
+    // Comando anterior ainda sem ack: espera por ele até CTL_ACK_TIMEOUT_MS
+    if (gen_rate.pending_seq != 0) {
+        if (xTaskGetTickCount() - gen_rate.pending_since < pdMS_TO_TICKS(CTL_ACK_TIMEOUT_MS)) {
+            return;
+        }
+        ctl_stats[CTL_SET_RATE].timeouts++;
+        gen_rate.pending_seq = 0;
+    }
+    
+    uint32_t dropped = 0;
+    for (int lane = 0; lane < LANE_COUNT; lane++) {
+        dropped += lane_stats[lane].dropped;
+    }
+    // Contadores zerados por CTL_RESET_COUNTERS recomeçam do zero
+    uint32_t new_drops = (dropped >= dropped_prev) ? dropped - dropped_prev : dropped;
+    dropped_prev = dropped;
+    
+    // Descartes com o receptor fora do OK são a falha dele, não pressão:
+    // recuar o gerador só esconderia a falha
+    if (!(atomic_load_explicit(&status_shadow, memory_order_acquire) & FLAG_RECEIVER_OK)) {
+        return;
+    }
+    
+    int32_t backoff_ms = gen_rate.backoff_ms;
+    int32_t base_ms = cfg_get(CFG_GENERATOR_PERIOD_MS);
+    int32_t target_ms = backoff_ms;
+    if (new_drops > 0) {
+        // Abaixo de live_gen e hb_stale: o recuo não pode disparar o próprio
+        // supervisor nem ser rejeitado pelo CTL_SET_RATE
+        int32_t limit_ms = base_ms * CTL_BACKOFF_MAX_FACTOR;
+        if (limit_ms > cfg_params[CFG_GENERATOR_PERIOD_MS].max) {
+            limit_ms = cfg_params[CFG_GENERATOR_PERIOD_MS].max;
+        }
+        if (limit_ms >= cfg_get(CFG_LIVENESS_GEN_MS)) {
+            limit_ms = cfg_get(CFG_LIVENESS_GEN_MS) - 1;
+        }
+        if (limit_ms >= cfg_get(CFG_HEARTBEAT_STALE_MS)) {
+            limit_ms = cfg_get(CFG_HEARTBEAT_STALE_MS) - 1;
+        }
+        target_ms = (backoff_ms ? backoff_ms : base_ms) * 2;
+        if (target_ms > limit_ms) {
+            target_ms = limit_ms;
+        }
+        if (target_ms <= base_ms) {
+            target_ms = 0;      // Sem folga entre gen_period e os prazos
+        }
+    } else if (backoff_ms != 0) {
+        target_ms = backoff_ms / 2;
+        if (target_ms <= base_ms) {
+            target_ms = 0;
+        }
+    }
+    
+    if (target_ms != backoff_ms) {
+        printf("%s AÇÃO: %" PRIu32 " descartes no envio, período do gerador %" PRId32 " -> %" PRId32 " ms\n",
+               TAG_SUP, new_drops, backoff_ms ? backoff_ms : base_ms, target_ms ? target_ms : base_ms);
+        uint16_t seq = ctl_send(LIVENESS_GENERATOR, CTL_SET_RATE, target_ms);
+        if (seq == 0) {
+            ctl_stats[CTL_SET_RATE].timeouts++;
+        } else {
+            gen_rate.pending_ms = target_ms;
+            gen_rate.pending_seq = seq;
+            gen_rate.pending_since = xTaskGetTickCount();
+        }
+    }
+}
+#endif
+
+void task_supervisor(void *pvParameters) {
+    int receiver_restart_count = 0;
+    TickType_t last_report = xTaskGetTickCount();
+    
+#if LIVENESS_ENABLED && !LOW_POWER_ENABLED
+    // O supervisor é o único agente que alimenta o TWDT
+    const TickType_t liveness_period = pdMS_TO_TICKS(LIVENESS_CHECK_PERIOD_MS);
+    TickType_t last_liveness = last_report;
+    if (esp_task_wdt_add_user("liveness", &liveness_wdt_user) != ESP_OK) {
+        printf("%s AVISO: Falha ao registrar agente de liveness no TWDT\n", TAG_WDT);
+    }
+#endif
+    
+    printf("%s Módulo de Supervisão iniciado\n", TAG_SUP);
+    
+    for (;;) {
+        uint32_t events = 0;
+        const TickType_t period = pdMS_TO_TICKS(cfg_get(CFG_SUPERVISOR_PERIOD_MS));
+        
+        // Tempo até o próximo relatório (ou verificação de liveness)
+        TickType_t elapsed = xTaskGetTickCount() - last_report;
+        TickType_t wait = (elapsed >= period) ? 0 : period - elapsed;
+#if LIVENESS_ENABLED && !LOW_POWER_ENABLED
+        TickType_t liveness_elapsed = xTaskGetTickCount() - last_liveness;
+        TickType_t liveness_wait = (liveness_elapsed >= liveness_period) ? 0 : liveness_period - liveness_elapsed;
+        if (liveness_wait < wait) {
+            wait = liveness_wait;
+        }
+#endif
+        
+#if SUPERVISOR_EVENT_DRIVEN
+        // Bloqueia até um evento de falha/escalonamento ou até o próximo prazo
+        xTaskNotifyWait(0, UINT32_MAX, &events, wait);
+#else
+        vTaskDelay(wait);
+#endif
+        
+        TickType_t now = xTaskGetTickCount();
+        int64_t now_us = esp_timer_get_time();
+        bool periodic = (now - last_report >= period);
+        
+#if LIVENESS_ENABLED && !LOW_POWER_ENABLED
+        if (now - last_liveness >= liveness_period) {
+            liveness_check_and_feed(now_us);
+            last_liveness = now;
+        }
+#endif
+        
+        // Confirmações de comandos enviados pelo console
+        ctl_drain_acks();
+        
+        // Em modo polling, as verificações de falha só rodam no período do supervisor
+        if (!SUPERVISOR_EVENT_DRIVEN && !periodic) {
+            continue;
+        }
+        
+        // Relatório periódico, ou imediato quando o receptor muda de nível
+        if (periodic || (events & SUP_EVT_RECEIVER_ESCALATION)) {
+#if STATUS_REPORT == STATUS_REPORT_JSON
+            supervisor_emit_status(xEventGroupGetBits(status_flags), now_us,
+                                   (events & SUP_EVT_RECEIVER_ESCALATION) != 0);
+#else
+            supervisor_print_status(xEventGroupGetBits(status_flags));
+#endif
+            if (periodic) {
+                last_report = now;
+            }
+        }
+        
+        // Relatório completo em texto pedido pelo console
+        if (atomic_exchange(&status_text_requested, false)) {
+            supervisor_print_status(xEventGroupGetBits(status_flags));
+        }
+        
+#if TRACE_RECORDER_ENABLED
+        // Janela cheia: despeja a timeline e começa outra
+        if (periodic && trace_window_full()) {
+            trace_dump();
+        }
+#endif
+        
+        // Heartbeat parado com a tarefa viva: antes de recriar, sonda o canal de
+        // controle. Um receptor que drena e confirma só está sem dados (o ack
+        // também renova o heartbeat); um travado nunca responde. O prazo cobre
+        // o rcv_delay em uso, em que um receptor sadio não lê comandos, mas não
+        // o CTL_ACK_TIMEOUT_MS inteiro, que só atrasaria a recuperação.
+        bool receiver_stale = receiver_task_handle != NULL &&
+            heartbeat_age_us(&receiver_heartbeat, now_us) > (int64_t)cfg_get(CFG_HEARTBEAT_STALE_MS) * 1000;
+        uint32_t probe_ms = (uint32_t)cfg_get(CFG_RECEIVER_DELAY_MS) + CTL_PROBE_MARGIN_MS;
+        if (receiver_stale &&
+            ctl_call_timeout(LIVENESS_RECEIVER, CTL_DRAIN, 0, probe_ms) == CTL_OK) {
+            printf("%s Receptor sem dados mas responsivo: drenado sem recriar\n", TAG_SUP);
+            receiver_stale = false;
+        }
+        
+        // Verifica se precisa recriar tarefa do receptor
+        if (receiver_task_handle == NULL || receiver_stale) {
+            fault_detected("heartbeat do receptor");
+            
+            // Mede a latência desde que o receptor sinalizou o encerramento
+            if (receiver_shutdown_signal_us != 0) {
+                int64_t latency_us = esp_timer_get_time() - receiver_shutdown_signal_us;
+                receiver_shutdown_signal_us = 0;
+                fault_action_last_us = latency_us;
+                if (latency_us > fault_action_max_us) {
+                    fault_action_max_us = latency_us;
+                }
+                fault_action_count++;
+                printf("%s Latência falha->ação: %" PRId64 " us\n", TAG_SUP, latency_us);
+            }
+            
+            printf("%s AÇÃO: Recriando tarefa do Receptor (tentativa %d)\n", 
+                   TAG_SUP, ++receiver_restart_count);
+            
+            if (receiver_task_handle != NULL) {
+                liveness_unregister(LIVENESS_RECEIVER, receiver_task_handle);
+                vTaskDelete(receiver_task_handle);
+                receiver_task_handle = NULL;
+                
+                // O receptor travado não drenou: escoa as faixas aqui, sem leitor ativo
+                uint32_t pending = lane_pending();
+                if (pending > 0) {
+                    lane_reset();
+                    printf("%s Faixas drenadas: %" PRIu32 " mensagens do receptor travado descartadas\n",
+                           TAG_SUP, pending);
+                }
+            }
+            
+            // Renova o heartbeat antes de criar a tarefa: só existe um escritor por vez
+            heartbeat_beat(&receiver_heartbeat);
+            
+            xTaskCreatePinnedToCore(
+                task_data_receiver,
+                "receiver_task",
+                cfg_get(CFG_RECEIVER_STACK),
+                NULL,
+                cfg_get(CFG_RECEIVER_PRIO),
+                &receiver_task_handle,
+                1
+            );
+            
+            status_clear_bits(FLAG_RECEIVER_WARNING | FLAG_RECEIVER_RECOVERY | FLAG_RECEIVER_SHUTDOWN);
+            fault_supervisor_action();
+            
+            // Se falhou muitas vezes, reinicia o sistema
+            if (receiver_restart_count >= 5) {
+                printf("%s REINICIALIZAÇÃO CRÍTICA: Falhas excessivas detectadas\n", TAG_WDT);
+                printf("%s Reiniciando ESP32 em 1 segundo...\n", TAG_MAIN);
+                vTaskDelay(pdMS_TO_TICKS(1000));
+                esp_restart();
+            }
+        }
+        
+        // Verifica gerador
+        if (heartbeat_age_us(&generator_heartbeat, now_us) > (int64_t)cfg_get(CFG_HEARTBEAT_STALE_MS) * 1000) {
+            fault_detected("heartbeat do gerador");
+            status_clear_bits(FLAG_GENERATOR_OK);
+#if GEN_SOURCE == GEN_SOURCE_TIMER
+            printf("%s AÇÃO: Rearmando o timer do Gerador\n", TAG_SUP);
+            gen_timer_restart();
+#else
+            printf("%s AÇÃO: Recriando tarefa do Gerador\n", TAG_SUP);
+            
+            if (generator_task_handle != NULL) {
+                liveness_unregister(LIVENESS_GENERATOR, generator_task_handle);
+#if LANE_TRANSPORT == LANE_TRANSPORT_NOTIFY
+                // O receptor não pode notificar um handle apagado
+                for (int lane = 0; lane < LANE_COUNT; lane++) {
+                    xport_notify_forget_writer(&lane_xports[lane]);
+                }
+#endif
+                vTaskDelete(generator_task_handle);
+                generator_task_handle = NULL;
+            }
+            
+            heartbeat_beat(&generator_heartbeat);
+            
+            xTaskCreatePinnedToCore(
+                task_data_generator,
+                "generator_task",
+                cfg_get(CFG_GENERATOR_STACK),
+                NULL,
+                cfg_get(CFG_GENERATOR_PRIO),
+                &generator_task_handle,
+                1
+            );
+#endif
+            fault_supervisor_action();
+        }
+        
+#if GEN_SOURCE == GEN_SOURCE_TIMER && GEN_RATE_PROBE_ENABLED
+        // Um passo da sonda de taxa máxima por relatório
+        if (periodic) {
+            gen_rate_probe_step();
+        }
+#elif GEN_SOURCE == GEN_SOURCE_TASK && REPLAY_MODE != REPLAY_MODE_REPLAY
+        // Pressão no envio: ajusta a taxa do gerador sem recriar tarefas
+        if (periodic) {
+            supervisor_adjust_generator_rate();
+        }
+#endif
+        
+        // Alerta de memória crítica
+        if (periodic && xPortGetMinimumEverFreeHeapSize() < 10 * 1024) {
+            printf("%s ALERTA CRÍTICO: Memória mínima muito baixa!\n", TAG_MEM);
+        }
+    }
+}
+
+/* ========== MÓDULO 4: TRANSMISSÃO ========== */
+#if TX_FORMAT == TX_FORMAT_BINARY && TX_CODEC == TX_CODEC_DELTA
+// Pior caso: cada valor em um quadro próprio com token de tamanho máximo
+#define TX_OUT_SIZE  (TX_BATCH_SIZE * (WIRE_DELTA_HEADER_SIZE + WIRE_VARINT_MAX + WIRE_CRC_SIZE))
+#elif TX_FORMAT == TX_FORMAT_BINARY
+// Pior caso: um quadro por WIRE_MAX_RECORDS valores do lote
+#define TX_OUT_SIZE  (TX_BATCH_SIZE * WIRE_RECORD_SIZE + \
+                      ((TX_BATCH_SIZE + WIRE_MAX_RECORDS - 1) / WIRE_MAX_RECORDS) * \
+                      (WIRE_HEADER_SIZE + WIRE_CRC_SIZE))
+#else
+#define TX_OUT_SIZE  (TX_BATCH_SIZE * TX_LINE_MAX)
+#endif
+
+// Serializa um lote no formato configurado; retorna o número de bytes
+static size_t tx_encode_batch(uint8_t *out, const tx_batch_t *batch) {
+    size_t len = 0;
+    
+#if TX_FORMAT == TX_FORMAT_BINARY && TX_CODEC == TX_CODEC_DELTA
+    // Estado do codec persiste entre lotes; keyframes periódicos
+    static delta_codec_t codec;
+    for (uint32_t first = 0; first < batch->count; ) {
+        uint32_t consumed;
+        len += codec_encode_frame(&codec, out + len, &batch->values[first],
+                                  batch->count - first, &consumed);
+        first += consumed;
+    }
+#elif TX_FORMAT == TX_FORMAT_BINARY
+    // Empacota o lote em quadros de até TX_FRAME_MTU bytes
+    for (uint32_t first = 0; first < batch->count; first += WIRE_MAX_RECORDS) {
+        uint32_t count = batch->count - first;
+        if (count > WIRE_MAX_RECORDS) {
+            count = WIRE_MAX_RECORDS;
+        }
+        len += wire_encode_frame(out + len, &batch->values[first], count);
+    }
+#else
+    for (uint32_t i = 0; i < batch->count; i++) {
+        len += (size_t)snprintf((char *)out + len, TX_OUT_SIZE - len,
+                                "%s >>> TRANSMITINDO: %d <<<\n", TAG_TX, batch->values[i]);
+    }
+#endif
+    return len;
+}
+
+void task_transmitter(void *pvParameters) {
+    static uint8_t out[TX_OUT_SIZE];
+    
+    printf("%s Módulo de Transmissão iniciado\n", TAG_TX);
+    
+    for (;;) {
+        uint8_t index;
+        
+        // Dorme até o receptor entregar um lote
+        xQueueReceive(tx_ready_queue, &index, portMAX_DELAY);
+        
+        tx_batch_t *batch = &tx_batches[index];
+        uint32_t encode_start = esp_cpu_get_cycle_count();
+        size_t len = tx_encode_batch(out, batch);
+        tx_stats.encode_cycles += esp_cpu_get_cycle_count() - encode_start;
+        
+        int64_t start_us = esp_timer_get_time();
+        tx_sink_write(out, len);
+        tx_stats.write_us += (uint32_t)(esp_timer_get_time() - start_us);
+        
+        tx_stats.bytes += (uint32_t)len;
+        tx_stats.values += batch->count;
+        tx_stats.batches++;
+        
+        // Devolve o buffer ao receptor
+        batch->count = 0;
+        xQueueSend(tx_free_queue, &index, 0);
+    }
+}
+
+/* ========== MÓDULO 5: INJEÇÃO DE FALHAS ========== */
+#if FAULT_INJECTION_ENABLED
+// Chamado pelo TWDT na ISR de timeout, antes do panic: guarda a detecção na RTC
+void esp_task_wdt_isr_user_handler(void) {
+    if (fault_rtc.magic == FAULT_RTC_MAGIC && fault_rtc.scenario == FAULT_WDT_STARVATION) {
+        fault_rtc.detect_us = esp_timer_get_time();
+        fault_rtc.in_flight = lane_depth(LANE_URGENT) + lane_depth(LANE_BULK) +
+                              (tx_fill_index >= 0 ? tx_batches[tx_fill_index].count : 0);
+    }
+}
+
+// Mensagens perdidas: lacunas de sequência + descartes por falta de buffer
+static uint32_t fault_lost_count(void) {
+    return rx_seq_gaps + tx_stats.dropped;
+}
+
+static void fault_print_result(const char *name, const fault_result_t *result) {
+    char detect[48];
+    char recover[24];
+    
+    if (result->detect_ms >= 0) {
+        snprintf(detect, sizeof(detect), "%" PRId64 " ms (%s)", result->detect_ms, result->detector);
+    } else {
+        snprintf(detect, sizeof(detect), "não detectada");
+    }
+    if (result->recover_ms >= 0) {
+        snprintf(recover, sizeof(recover), "%" PRId64 " ms", result->recover_ms);
+    } else {
+        snprintf(recover, sizeof(recover), "não recuperou");
+    }
+    printf("%s Falha '%s': detecção %s, recuperação %s, %" PRIu32 " mensagens perdidas\n",
+           TAG_FAULT, name, detect, recover, result->lost);
+}
+
+// Injeta um cenário e espera até o sistema voltar a entregar dados
+static fault_result_t fault_run(fault_id_t id) {
+    const fault_scenario_t *scenario = &fault_scenarios[id];
+    fault_result_t result = { .detect_ms = -1, .recover_ms = -1, .detector = "-" };
+    
+    printf("%s Injetando falha '%s'\n", TAG_FAULT, scenario->name);
+    atomic_store(&fault.ended, false);
+    atomic_store(&fault.detected, false);
+    atomic_store(&fault.recovered, false);
+    fault.lost_start = fault_lost_count();
+    fault.inject_us = esp_timer_get_time();
+    if (id == FAULT_WDT_STARVATION) {
+        // O resultado só pode ser concluído depois do reset
+        fault_rtc = (fault_rtc_record_t){
+            .magic = FAULT_RTC_MAGIC, .scenario = id, .inject_us = fault.inject_us,
+        };
+    }
+    atomic_store_explicit(&fault.active, id, memory_order_release);
+    
+    for (;;) {
+        vTaskDelay(pdMS_TO_TICKS(FAULT_POLL_MS));
+        int64_t elapsed_us = esp_timer_get_time() - fault.inject_us;
+        
+        if (scenario->duration_ms > 0 && elapsed_us >= (int64_t)scenario->duration_ms * 1000) {
+            fault_end();
+        }
+        if (atomic_load(&fault.recovered) ||
+            elapsed_us >= (int64_t)(scenario->duration_ms + FAULT_SCENARIO_TIMEOUT_MS) * 1000) {
+            break;
+        }
+    }
+    fault_end();
+    atomic_store_explicit(&fault.active, FAULT_NONE, memory_order_release);
+    fault_rtc.magic = 0;
+    
+    if (atomic_load(&fault.detected)) {
+        result.detect_ms = (fault.detect_us - fault.inject_us) / 1000;
+        result.detector = fault.detector;
+    }
+    if (atomic_load(&fault.recovered)) {
+        result.recover_ms = (fault.recover_us - fault.inject_us) / 1000;
+    }
+    result.lost = fault_lost_count() - fault.lost_start;
+    fault_print_result(scenario->name, &result);
+    return result;
+}
+
+// Roda todos os cenários; a starvation do TWDT fica por último porque reinicia o chip
+static void fault_run_all(void) {
+    fault_result_t results[FAULT_COUNT];
+    
+    for (int id = FAULT_NONE + 1; id < FAULT_WDT_STARVATION; id++) {
+        results[id] = fault_run((fault_id_t)id);
+        vTaskDelay(pdMS_TO_TICKS(FAULT_SETTLE_MS));
+    }
+    
+    printf("\n%s ========== RESUMO DAS FALHAS ==========\n", TAG_FAULT);
+    for (int id = FAULT_NONE + 1; id < FAULT_WDT_STARVATION; id++) {
+        fault_print_result(fault_scenarios[id].name, &results[id]);
+    }
+    incident_print(&receiver_incidents, esp_timer_get_time());
+    incident_print(&generator_incidents, esp_timer_get_time());
+    printf("%s ========================================\n\n", TAG_FAULT);
+    
+    printf("%s Último cenário reinicia o sistema; o resultado sai após o boot\n", TAG_FAULT);
+    fault_run(FAULT_WDT_STARVATION);
+}
+
+// Conclui o cenário de starvation após o reset; verdadeiro se havia um em andamento
+static bool fault_report_reset(void) {
+    esp_reset_reason_t reason = esp_reset_reason();
+    fault_rtc_record_t record = fault_rtc;
+    fault_rtc.magic = 0;
+    
+    if (record.magic != FAULT_RTC_MAGIC || reason == ESP_RST_POWERON) {
+        return false;
+    }
+    
+    printf("%s Reset durante a falha '%s' (motivo %d%s)\n", TAG_FAULT,
+           fault_scenarios[FAULT_WDT_STARVATION].name, (int)reason,
+           reason == ESP_RST_TASK_WDT ? ": TWDT" : "");
+    
+    // Recuperação = injeção -> reset + boot -> primeiro valor entregue
+    fault_result_t result = { .detect_ms = -1, .recover_ms = -1, .detector = "TWDT" };
+    atomic_store(&fault.ended, true);
+    atomic_store(&fault.recovered, false);
+    atomic_store_explicit(&fault.active, FAULT_WDT_STARVATION, memory_order_release);
+    while (!atomic_load(&fault.recovered) &&
+           esp_timer_get_time() < (int64_t)FAULT_SCENARIO_TIMEOUT_MS * 1000) {
+        vTaskDelay(pdMS_TO_TICKS(FAULT_POLL_MS));
+    }
+    atomic_store_explicit(&fault.active, FAULT_NONE, memory_order_release);
+    
+    int64_t reset_ms = 0;
+    if (record.detect_us != 0) {
+        result.detect_ms = (record.detect_us - record.inject_us) / 1000;
+        reset_ms = result.detect_ms;
+    }
+    if (atomic_load(&fault.recovered)) {
+        result.recover_ms = reset_ms + fault.recover_us / 1000;
+    }
+    result.lost = record.in_flight;
+    fault_print_result(fault_scenarios[FAULT_WDT_STARVATION].name, &result);
+    return true;
+}
+
+// Comando do console: "fault all" ou "fault <cenário>" (executado pela tarefa de falhas)
+static void fault_console_command(const char *arg) {
+    uint8_t id = FAULT_NONE;
+    
+    if (strcmp(arg, "all") == 0) {
+        id = FAULT_COUNT;
+    }
+    for (int i = FAULT_NONE + 1; i < FAULT_COUNT; i++) {
+        if (strcmp(arg, fault_scenarios[i].name) == 0) {
+            id = (uint8_t)i;
+        }
+    }
+    
+    if (id == FAULT_NONE) {
+        printf("%s Uso: fault all | fault <cenário>. Cenários:", TAG_FAULT);
+        for (int i = FAULT_NONE + 1; i < FAULT_COUNT; i++) {
+            printf(" %s", fault_scenarios[i].name);
+        }
+        printf("\n");
+    } else if (xQueueSend(fault_cmd_queue, &id, 0) != pdTRUE) {
+        printf("%s Já há um cenário na fila, comando ignorado\n", TAG_FAULT);
+    }
+}
+
+void task_fault_injector(void *pvParameters) {
+    printf("%s Módulo de Injeção de Falhas iniciado (console: fault all | fault <cenário>)\n", TAG_FAULT);
+    
+    bool after_reset = fault_report_reset();
+#if FAULT_AUTORUN
+    // Não repete a sequência depois do reset do último cenário
+    if (!after_reset) {
+        vTaskDelay(pdMS_TO_TICKS(FAULT_WARMUP_MS));
+        fault_run_all();
+    }
+#else
+    (void)after_reset;
+#endif
+    
+    for (;;) {
+        uint8_t id;
+        if (xQueueReceive(fault_cmd_queue, &id, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        if (id == FAULT_COUNT) {
+            fault_run_all();
+        } else {
+            fault_run((fault_id_t)id);
+        }
+    }
+}
+#endif
+
+/* ========== MÓDULO 6: CONSOLE ========== */
+// Lê uma linha do console sem bloquear (stdin do IDF retorna EOF sem dados)
+static bool console_read_line(char *line, size_t size, size_t *len) {
+    int c;
+    while ((c = getchar()) != EOF) {
+        if (c == '\r' || c == '\n') {
+            if (*len == 0) {
+                continue;
+            }
+            line[*len] = '\0';
+            *len = 0;
+            return true;
+        }
+        if (*len < size - 1) {
+            line[(*len)++] = (char)c;
+        }
+    }
+    clearerr(stdin);
+    return false;
+}
+
+static void cfg_print(void) {
+    static const char *const units[] = {
+        [CFG_TYPE_COUNT] = "", [CFG_TYPE_MS] = " ms", [CFG_TYPE_PRIO] = "", [CFG_TYPE_BYTES] = " B",
+    };
+    
+    for (int i = 0; i < CFG_COUNT; i++) {
+        const cfg_param_t *param = &cfg_params[i];
+        printf("%s %-13s = %" PRId32 "%s (padrão %" PRId32 ", [%" PRId32 ", %" PRId32 "], %s)\n",
+               TAG_CFG, param->key, cfg_get((cfg_id_t)i), units[param->type], param->def,
+               param->min, param->max, param->hot ? "imediato" : "no boot");
+    }
+}
+
+// Comandos: "cfg", "cfg set <chave> <valor>", "cfg reset"
+static void cfg_console_command(const char *arg) {
+    char key[16];
+    long value;
+    
+    if (*arg == '\0') {
+        cfg_print();
+    } else if (strcmp(arg, "reset") == 0) {
+        bool ok = cfg_reset();
+        printf("%s %s\n", TAG_CFG, ok ? "Padrões restaurados (tamanhos e prioridades no próximo boot)"
+                                       : "ERRO: falha ao apagar o NVS");
+        supervisor_notify(SUP_EVT_CONFIG_CHANGED);
+    } else if (sscanf(arg, "set %15s %ld", key, &value) == 2) {
+        cfg_id_t id = cfg_find(key);
+        const char *error = (id == CFG_COUNT) ? "chave desconhecida" : cfg_set(id, (int32_t)value);
+        if (error != NULL) {
+            printf("%s ERRO: %s = %ld rejeitado (%s)\n", TAG_CFG, key, value, error);
+        } else if (cfg_params[id].hot) {
+            printf("%s %s = %ld aplicado e salvo\n", TAG_CFG, key, value);
+            supervisor_notify(SUP_EVT_CONFIG_CHANGED);
+        } else {
+            printf("%s %s = %ld salvo, vale no próximo boot\n", TAG_CFG, key, value);
+        }
+    } else {
+        printf("%s Uso: cfg | cfg set <chave> <valor> | cfg reset\n", TAG_CFG);
+    }
+}
+
+// Comando do console: "ctl <tarefa> <comando> [argumento]" (ack registrado pelo supervisor)
+static void ctl_console_command(const char *arg) {
+    char task_name[16];
+    char cmd_name[16];
+    long value = 0;
+    int task = LIVENESS_TASK_COUNT;
+    int cmd = CTL_COUNT;
+    
+    if (sscanf(arg, "%15s %15s %ld", task_name, cmd_name, &value) >= 2) {
+        for (int i = 0; i < LIVENESS_TASK_COUNT; i++) {
+            if (strcmp(task_name, liveness_slots[i].name) == 0) {
+                task = i;
+            }
+        }
+        for (int i = 0; i < CTL_COUNT; i++) {
+            if (strcmp(cmd_name, ctl_names[i]) == 0) {
+                cmd = i;
+            }
+        }
+    }
+    
+    if (task == LIVENESS_TASK_COUNT || cmd == CTL_COUNT) {
+        printf("%s Uso: ctl <gerador|receptor> <comando> [argumento]. Comandos:", TAG_CTL);
+        for (int i = 0; i < CTL_COUNT; i++) {
+            printf(" %s", ctl_names[i]);
+        }
+        printf("\n");
+        return;
+    }
+    
+    if (GEN_SOURCE == GEN_SOURCE_TIMER && task == LIVENESS_GENERATOR) {
+        printf("%s O gerador por timer não tem canal de controle\n", TAG_CTL);
+        return;
+    }
+    
+    uint16_t seq = ctl_send((liveness_id_t)task, (ctl_cmd_t)cmd, (int32_t)value);
+    if (seq == 0) {
+        printf("%s Fila de controle de %s cheia, comando ignorado\n", TAG_CTL, liveness_slots[task].name);
+    } else {
+        printf("%s %s/%s #%u enviado\n", TAG_CTL, liveness_slots[task].name, ctl_names[cmd], (unsigned int)seq);
+    }
+}
+
+void task_console(void *pvParameters) {
+    char line[CONSOLE_LINE_MAX];
+    size_t len = 0;
+    
+    for (;;) {
+        if (console_read_line(line, sizeof(line), &len)) {
+            // Separa o comando do argumento
+            char *arg = strchr(line, ' ');
+            if (arg != NULL) {
+                *arg++ = '\0';
+                while (*arg == ' ') {
+                    arg++;
+                }
+            } else {
+                arg = line + strlen(line);
+            }
+            
+            if (strcmp(line, "cfg") == 0) {
+                cfg_console_command(arg);
+            } else if (strcmp(line, "ctl") == 0) {
+                ctl_console_command(arg);
+            } else if (strcmp(line, "status") == 0) {
+                // O supervisor imprime: os deltas do relatório são estado dele
+                atomic_store(&status_text_requested, true);
+                supervisor_notify(SUP_EVT_STATUS_REQUEST);
+#if FAULT_INJECTION_ENABLED
+            } else if (strcmp(line, "fault") == 0) {
+                fault_console_command(arg);
+#endif
+            } else {
+                printf("%s Comando desconhecido: %s (cfg, ctl, status%s)\n", TAG_MAIN, line,
+                       FAULT_INJECTION_ENABLED ? ", fault" : "");
+            }
+        }
+        vTaskDelay(pdMS_TO_TICKS(CONSOLE_POLL_MS));
+    }
+}
+
+/* ========== BENCHMARK DE CRC32 ========== */
+#if CRC_BENCHMARK_ENABLED
+typedef uint32_t (*crc32_bench_fn_t)(const uint8_t *data, size_t len);
+
+static uint32_t crc32_bench_bytewise(const uint8_t *data, size_t len) {
+    return ~crc32_update_bytewise(0xFFFFFFFFu, data, len);
+}
+
+static uint32_t crc32_bench_slice8(const uint8_t *data, size_t len) {
+    return ~crc32_update_slice8(0xFFFFFFFFu, data, len);
+}
+
+static uint32_t crc32_bench_rom(const uint8_t *data, size_t len) {
+    return esp_rom_crc32_le(0, data, (uint32_t)len);
+}
+
+// Vazão de cada implementação por tamanho de payload (MB/s e ns/mensagem)
+static void crc32_benchmark(void) {
+    static const size_t sizes[] = { 8, 16, 64, 256, 1024, 4096 };
+    static const struct {
+        const char *name;
+        crc32_bench_fn_t fn;
+    } impls[] = {
+        { "bytewise", crc32_bench_bytewise },
+        { "slice8",   crc32_bench_slice8 },
+        { "rom",      crc32_bench_rom },
+    };
+    static uint8_t buffer[4096];
+    
+    for (size_t i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = (uint8_t)(i * 31u + 7u);
+    }
+    
+    // As três implementações precisam concordar antes de medir
+    uint32_t reference = crc32_bench_bytewise(buffer, sizeof(buffer));
+    for (size_t k = 0; k < sizeof(impls) / sizeof(impls[0]); k++) {
+        if (impls[k].fn(buffer, sizeof(buffer)) != reference) {
+            printf("%s ERRO: CRC32 %s diverge da referência\n", TAG_MAIN, impls[k].name);
+        }
+    }
+    
+    printf("%s Benchmark CRC32 (tamanho: MB/s | ns/mensagem)\n", TAG_MAIN);
+    for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+        printf("%s   %4u B:", TAG_MAIN, (unsigned int)sizes[s]);
+        for (size_t k = 0; k < sizeof(impls) / sizeof(impls[0]); k++) {
+            volatile uint32_t sink = 0;
+            uint32_t iterations = (uint32_t)(256 * 1024 / sizes[s]);
+            int64_t start_us = esp_timer_get_time();
+            for (uint32_t n = 0; n < iterations; n++) {
+                sink ^= impls[k].fn(buffer, sizes[s]);
+            }
+            int64_t elapsed_us = esp_timer_get_time() - start_us;
+            (void)sink;
+            if (elapsed_us <= 0) {
+                elapsed_us = 1;
+            }
+            printf("  %s %.1f | %.0f", impls[k].name,
+                   (double)iterations * (double)sizes[s] / (double)elapsed_us,
+                   (double)elapsed_us * 1000.0 / (double)iterations);
+        }
+        printf("\n");
+    }
+}
+#endif
+
+/* ========== BENCHMARK DE TRANSPORTE ========== */
+#if XPORT_BENCHMARK_ENABLED
+typedef struct {
+    void *xport;
+    SemaphoreHandle_t done;
+} xport_bench_ctx_t;
+
+typedef struct {
+    double single_ns;           // Envio + recepção de uma mensagem, mesma tarefa
+    double batch_ns;            // ...em lotes de XPORT_BENCH_BATCH, por mensagem
+    double cross_msg_s;         // Produtor no outro núcleo, consumidor aqui
+    uint32_t errors;            // Mensagens perdidas, duplicadas ou fora de ordem
+    xport_stats_t stats;
+} xport_bench_result_t;
+
+/* Mesma carga para cada transporte, com as chamadas inlinadas como no
+ * pipeline. Nas três fases, o produtor tenta de novo sem esperar. */
+#define XPORT_BENCH_DEFINE(impl)                                                                  \
+static void xport_bench_producer_##impl(void *arg) {                                               \
+    xport_bench_ctx_t *ctx = arg;                                                                   \
+    data_msg_t msg = { 0 };                                                                         \
+    for (uint32_t n = 1; n <= XPORT_BENCH_MESSAGES; n++) {                                          \
+        msg.seq = n;                                                                                \
+        while (!xport_##impl##_send(ctx->xport, &msg, 0)) {                                         \
+        }                                                                                           \
+    }                                                                                               \
+    xSemaphoreGive(ctx->done);                                                                      \
+    vTaskDelete(NULL);                                                                              \
+}                                                                                                   \
+                                                                                                    \
+static bool xport_bench_run_##impl(xport_bench_result_t *result) {                                  \
+    static data_msg_t batch[XPORT_BENCH_BATCH];                                                     \
+    xport_##impl##_t x;                                                                             \
+    data_msg_t msg = { 0 };                                                                         \
+    uint32_t moved = 0;                                                                             \
+                                                                                                    \
+    memset(result, 0, sizeof(*result));                                                             \
+    if (!xport_##impl##_create(&x, XPORT_BENCH_LENGTH)) {                                           \
+        return false;                                                                               \
+    }                                                                                               \
+                                                                                                    \
+    int64_t start_us = esp_timer_get_time();                                                        \
+    for (uint32_t n = 0; n < XPORT_BENCH_MESSAGES; n++) {                                           \
+        msg.seq = n;                                                                                \
+        xport_##impl##_send(&x, &msg, 0);                                                           \
+        if (!xport_##impl##_receive(&x, &msg) || msg.seq != n) {                                    \
+            result->errors++;                                                                       \
+        }                                                                                           \
+    }                                                                                               \
+    result->single_ns = (double)(esp_timer_get_time() - start_us) * 1000.0 / XPORT_BENCH_MESSAGES;  \
+                                                                                                    \
+    start_us = esp_timer_get_time();                                                                \
+    for (uint32_t n = 0; n < XPORT_BENCH_MESSAGES; n += XPORT_BENCH_BATCH) {                        \
+        for (uint32_t i = 0; i < XPORT_BENCH_BATCH; i++) {                                          \
+            batch[i].seq = n + i;                                                                   \
+        }                                                                                           \
+        uint32_t sent = xport_##impl##_send_batch(&x, batch, XPORT_BENCH_BATCH);                    \
+        if (xport_##impl##_receive_batch(&x, batch, XPORT_BENCH_BATCH) != sent) {                   \
+            result->errors++;                                                                       \
+        }                                                                                           \
+        moved += sent;                                                                              \
+    }                                                                                               \
+    result->batch_ns = (double)(esp_timer_get_time() - start_us) * 1000.0 / (moved ? moved : 1);    \
+                                                                                                    \
+    xport_bench_ctx_t ctx = { .xport = &x, .done = xSemaphoreCreateBinary() };                      \
+    if (ctx.done != NULL) {                                                                         \
+        uint32_t expected = 1;                                                                      \
+        start_us = esp_timer_get_time();                                                            \
+        xTaskCreatePinnedToCore(xport_bench_producer_##impl, "xport_bench", 2048, &ctx,             \
+                                uxTaskPriorityGet(NULL), NULL, 1 - xPortGetCoreID());               \
+        while (expected <= XPORT_BENCH_MESSAGES) {                                                  \
+            if (xport_##impl##_receive(&x, &msg)) {                                                 \
+                if (msg.seq != expected) {                                                          \
+                    result->errors++;                                                               \
+                }                                                                                   \
+                expected = msg.seq + 1;                                                             \
+            }                                                                                       \
+        }                                                                                           \
+        xSemaphoreTake(ctx.done, portMAX_DELAY);                                                    \
+        int64_t elapsed_us = esp_timer_get_time() - start_us;                                       \
+        result->cross_msg_s = 1e6 * XPORT_BENCH_MESSAGES / (double)(elapsed_us > 0 ? elapsed_us : 1); \
+        vSemaphoreDelete(ctx.done);                                                                 \
+    }                                                                                               \
+                                                                                                    \
+    result->stats = x.stats;                                                                        \
+    xport_##impl##_destroy(&x);                                                                     \
+    return true;                                                                                    \
+}
+
+XPORT_BENCH_DEFINE(queue)
+XPORT_BENCH_DEFINE(msgbuf)
+XPORT_BENCH_DEFINE(stream)
+XPORT_BENCH_DEFINE(spsc)
+XPORT_BENCH_DEFINE(notify)
 
-/* Identificador personalizado */
-#define USER_ID "{Lucas-RM86920}"
+/* Fase de payloads variáveis: os mesmos tamanhos e a mesma mistura em cada
+ * armazenamento, com a mesma RAM. A fila representa os transportes de slot
+ * fixo (o anel SPSC e a caixa postal também reservam o maior payload por
+ * slot); o message buffer prefixa o tamanho sozinho e o stream buffer
+ * recebe um prefixo de 2 bytes gravado junto com o payload. */
+typedef enum {
+    XPORT_PAYLOAD_SLOT,
+    XPORT_PAYLOAD_MSGBUF,
+    XPORT_PAYLOAD_STREAM,
+    XPORT_PAYLOAD_COUNT
+} xport_payload_kind_t;
 
-/* Tags personalizadas */
-#define TAG_GEN USER_ID " [GERADOR]"
-#define TAG_RCV USER_ID " [RECEPTOR]"
-#define TAG_SUP USER_ID " [SUPERVISOR]"
-#define TAG_QUEUE USER_ID " [FILA]"
-#define TAG_WDT USER_ID " [WATCHDOG]"
-#define TAG_MEM USER_ID " [MEMORIA]"
-#define TAG_MAIN USER_ID " [SISTEMA]"
+typedef struct {
+    uint16_t len;
+    uint8_t data[XPORT_BENCH_MAX_PAYLOAD];
+} xport_bench_slot_t;
 
-/* ========== VARIÁVEIS GLOBAIS ========== */
-static QueueHandle_t data_queue = NULL;
-static EventGroupHandle_t status_flags = NULL;
-static TaskHandle_t generator_task_handle = NULL;
-static TaskHandle_t receiver_task_handle = NULL;
+static const char *const xport_payload_names[XPORT_PAYLOAD_COUNT] = { "fila", "msgbuf", "stream" };
+
+// Mistura típica de payloads: 70% pequenos, 25% médios, 5% grandes
+static size_t xport_bench_mix_len(uint32_t i) {
+    uint32_t r = (i * 2654435761u) >> 16;
+    uint32_t bucket = r % 100;
+    if (bucket < 70) {
+        return 8 + r % 25;                  // 8..32
+    } else if (bucket < 95) {
+        return 33 + r % 96;                 // 33..128
+    }
+    return 129 + r % (XPORT_BENCH_MAX_PAYLOAD - 128);
+}
 
-/* Heartbeats para monitoramento */
-static volatile uint32_t generator_heartbeat = 0;
-static volatile uint32_t receiver_heartbeat = 0;
+static void *xport_payload_create(xport_payload_kind_t kind) {
+    switch (kind) {
+        case XPORT_PAYLOAD_SLOT:
+            return xQueueCreate(XPORT_BENCH_RAM / sizeof(xport_bench_slot_t), sizeof(xport_bench_slot_t));
+        case XPORT_PAYLOAD_MSGBUF:
+            return xMessageBufferCreate(XPORT_BENCH_RAM);
+        default:
+            return xStreamBufferCreate(XPORT_BENCH_RAM, 1);
+    }
+}
 
-/* ========== MÓDULO 1: GERAÇÃO DE DADOS ========== */
-void task_data_generator(void *pvParameters) {
-    // Inscreve a tarefa no Watchdog
-    esp_task_wdt_add(NULL);
-    
-    int sequential_value = 0;
-    
-    printf("%s Módulo de Geração iniciado\n", TAG_GEN);
+static void xport_payload_destroy(xport_payload_kind_t kind, void *handle) {
+    if (kind == XPORT_PAYLOAD_SLOT) {
+        vQueueDelete(handle);
+    } else if (kind == XPORT_PAYLOAD_MSGBUF) {
+        vMessageBufferDelete(handle);
+    } else {
+        vStreamBufferDelete(handle);
+    }
+}
+
+// Tudo ou nada: o stream confere o espaço antes para não gravar registro pela metade
+static bool xport_payload_send(xport_payload_kind_t kind, void *handle, const xport_bench_slot_t *slot) {
+    size_t record = sizeof(slot->len) + slot->len;
+    switch (kind) {
+        case XPORT_PAYLOAD_SLOT:
+            return xQueueSend(handle, slot, 0) == pdTRUE;
+        case XPORT_PAYLOAD_MSGBUF:
+            return xMessageBufferSend(handle, slot->data, slot->len, 0) == slot->len;
+        default:
+            return xStreamBufferSpacesAvailable(handle) >= record &&
+                   xStreamBufferSend(handle, slot, record, 0) == record;
+    }
+}
+
+// Devolve o tamanho recebido (0 = vazio)
+static size_t xport_payload_receive(xport_payload_kind_t kind, void *handle, xport_bench_slot_t *slot) {
+    switch (kind) {
+        case XPORT_PAYLOAD_SLOT:
+            return (xQueueReceive(handle, slot, 0) == pdTRUE) ? slot->len : 0;
+        case XPORT_PAYLOAD_MSGBUF:
+            return xMessageBufferReceive(handle, slot->data, sizeof(slot->data), 0);
+        default:
+            if (xStreamBufferReceive(handle, &slot->len, sizeof(slot->len), 0) != sizeof(slot->len) ||
+                slot->len > sizeof(slot->data)) {
+                return 0;
+            }
+            return xStreamBufferReceive(handle, slot->data, slot->len, 0);
+    }
+}
+
+// Enche o transporte com a mistura e devolve quantas mensagens couberam
+static uint32_t xport_payload_fill(xport_payload_kind_t kind, void *handle, uint32_t *payload_bytes) {
+    static xport_bench_slot_t slot;
+    uint32_t count = 0;
     
+    *payload_bytes = 0;
     for (;;) {
-        sequential_value++;
-        
-        // Tenta enviar para a fila sem bloquear
-        if (xQueueSend(data_queue, &sequential_value, pdMS_TO_TICKS(QUEUE_SEND_TIMEOUT_MS)) == pdTRUE) {
-            printf("%s Dado enviado com sucesso!\n", TAG_QUEUE);
-            printf("%s Valor %d gerado e adicionado à fila\n", TAG_GEN, sequential_value);
-            
-            // Atualiza flag de status
-            xEventGroupSetBits(status_flags, FLAG_GENERATOR_OK);
-            generator_heartbeat = xTaskGetTickCount();
-        } else {
-            // Fila cheia - descarta valor mas continua funcionando
-            printf("%s Fila cheia! Dado descartado\n", TAG_QUEUE);
-            printf("%s AVISO: Valor %d descartado (fila lotada)\n", TAG_GEN, sequential_value);
+        slot.len = (uint16_t)xport_bench_mix_len(count);
+        if (!xport_payload_send(kind, handle, &slot)) {
+            return count;
         }
-        
-        // Reseta o watchdog
-        esp_task_wdt_reset();
-        
-        // Delay entre gerações (200ms)
-        vTaskDelay(pdMS_TO_TICKS(200));
+        *payload_bytes += slot.len;
+        count++;
     }
 }
 
-/* ========== MÓDULO 2: RECEPÇÃO DE DADOS ========== */
-void task_data_receiver(void *pvParameters) {
-    // Inscreve a tarefa no Watchdog
-    esp_task_wdt_add(NULL);
+// Envio + recepção sem espera na mesma tarefa; ns por mensagem
+static double xport_payload_roundtrip(xport_payload_kind_t kind, void *handle, size_t fixed_len,
+                                      uint32_t *errors) {
+    static xport_bench_slot_t tx_slot;
+    static xport_bench_slot_t rx_slot;
     
-    int timeout_count = 0;
-    int warning_count = 0;
-    int recovery_count = 0;
-    int shutdown_count = 0;
+    for (size_t i = 0; i < sizeof(tx_slot.data); i++) {
+        tx_slot.data[i] = (uint8_t)(i * 13u + 1u);
+    }
     
-    printf("%s Módulo de Recepção iniciado\n", TAG_RCV);
+    int64_t start_us = esp_timer_get_time();
+    for (uint32_t n = 0; n < XPORT_BENCH_MESSAGES; n++) {
+        tx_slot.len = (uint16_t)(fixed_len ? fixed_len : xport_bench_mix_len(n));
+        xport_payload_send(kind, handle, &tx_slot);
+        size_t got = xport_payload_receive(kind, handle, &rx_slot);
+        if (got != tx_slot.len || rx_slot.data[got - 1] != tx_slot.data[got - 1]) {
+            (*errors)++;
+        }
+    }
+    int64_t elapsed_us = esp_timer_get_time() - start_us;
+    return (double)(elapsed_us > 0 ? elapsed_us : 1) * 1000.0 / XPORT_BENCH_MESSAGES;
+}
+
+static void xport_payload_benchmark(void) {
+    static const size_t sizes[] = { 8, 32, 128, XPORT_BENCH_MAX_PAYLOAD, 0 };   // 0 = mistura
     
-    for (;;) {
-        // Aloca memória dinamicamente para armazenar o valor
-        int *received_value = (int *)malloc(sizeof(int));
-        
-        if (received_value == NULL) {
-            printf("%s ERRO CRÍTICO: Falha na alocação de memória!\n", TAG_MEM);
-            vTaskDelay(pdMS_TO_TICKS(100));
+    printf("%s Payloads variáveis (%u B de armazenamento, 8 a %u B; tamanho: ns/msg)\n",
+           TAG_MAIN, (unsigned int)XPORT_BENCH_RAM, (unsigned int)XPORT_BENCH_MAX_PAYLOAD);
+    for (int k = 0; k < XPORT_PAYLOAD_COUNT; k++) {
+        xport_payload_kind_t kind = (xport_payload_kind_t)k;
+        void *handle = xport_payload_create(kind);
+        if (handle == NULL) {
+            printf("%s   %-6s: sem memória\n", TAG_MAIN, xport_payload_names[k]);
             continue;
         }
         
-        // Tenta receber dados da fila com timeout
-        if (xQueueReceive(data_queue, received_value, pdMS_TO_TICKS(QUEUE_RECV_TIMEOUT_MS)) == pdTRUE) {
-            // Sucesso na recepção
-            printf("%s Dado recebido da fila\n", TAG_QUEUE);
-            printf("%s >>> TRANSMITINDO: %d <<<\n", TAG_RCV, *received_value);
-            
-            // Reset dos contadores
-            timeout_count = 0;
-            warning_count = 0;
-            recovery_count = 0;
-            
-            // Atualiza flags
-            xEventGroupSetBits(status_flags, FLAG_RECEIVER_OK);
-            xEventGroupClearBits(status_flags, FLAG_RECEIVER_WARNING | FLAG_RECEIVER_RECOVERY | FLAG_RECEIVER_SHUTDOWN);
-            
-            receiver_heartbeat = xTaskGetTickCount();
-            
-        } else {
-            // Timeout - não recebeu dados
-            timeout_count++;
-            printf("%s TIMEOUT: Nenhum dado recebido na fila (tentativa %d)\n", TAG_RCV, timeout_count);
-            
-            // REAÇÃO ESCALONADA
-            if (timeout_count >= 1 && timeout_count < MAX_WARNINGS) {
-                // Nível 1: Avisos
-                warning_count++;
-                printf("%s [NIVEL 1 - AVISO %d/%d] Fila sem dados\n", TAG_RCV, warning_count, MAX_WARNINGS);
-                xEventGroupSetBits(status_flags, FLAG_RECEIVER_WARNING);
-                
-            } else if (timeout_count >= MAX_WARNINGS && timeout_count < MAX_RECOVERIES) {
-                // Nível 2: Tentativa de recuperação
-                recovery_count++;
-                printf("%s [NIVEL 2 - RECUPERAÇÃO %d/%d] Resetando fila e limpando buffers\n", 
-                       TAG_RCV, recovery_count, MAX_RECOVERIES);
-                xQueueReset(data_queue);
-                xEventGroupSetBits(status_flags, FLAG_RECEIVER_RECOVERY);
-                xEventGroupClearBits(status_flags, FLAG_RECEIVER_WARNING);
-                
-            } else if (timeout_count >= MAX_RECOVERIES && timeout_count < MAX_SHUTDOWNS) {
-                // Nível 3: Preparação para encerramento
-                shutdown_count++;
-                printf("%s [NIVEL 3 - CRÍTICO %d/%d] Preparando para encerramento\n", 
-                       TAG_RCV, shutdown_count, MAX_SHUTDOWNS);
-                xEventGroupSetBits(status_flags, FLAG_RECEIVER_SHUTDOWN);
-                xEventGroupClearBits(status_flags, FLAG_RECEIVER_WARNING | FLAG_RECEIVER_RECOVERY);
-                
+        uint32_t bytes;
+        uint32_t count = xport_payload_fill(kind, handle, &bytes);
+        printf("%s   %-6s: mistura ocupa %" PRIu32 " mensagens, %" PRIu32 " B úteis (%.0f%%);",
+               TAG_MAIN, xport_payload_names[k], count, bytes, 100.0 * bytes / XPORT_BENCH_RAM);
+        xport_bench_slot_t drain;
+        while (xport_payload_receive(kind, handle, &drain) != 0) {
+        }
+        
+        uint32_t errors = 0;
+        for (size_t s = 0; s < sizeof(sizes) / sizeof(sizes[0]); s++) {
+            double ns = xport_payload_roundtrip(kind, handle, sizes[s], &errors);
+            if (sizes[s] != 0) {
+                printf(" %u B: %.0f", (unsigned int)sizes[s], ns);
             } else {
-                // Nível 4: Encerramento da tarefa
-                printf("%s [NIVEL 4 - ENCERRAMENTO] Falha persistente detectada\n", TAG_RCV);
-                printf("%s Finalizando módulo de recepção\n", TAG_RCV);
-                free(received_value);
-                xEventGroupSetBits(status_flags, FLAG_RECEIVER_SHUTDOWN);
-                vTaskDelete(NULL);
-                return;
+                printf(" mistura: %.0f", ns);
             }
         }
-        
-        // Libera memória alocada
-        free(received_value);
-        
-        // Reseta o watchdog
-        esp_task_wdt_reset();
-        
-        // Pequeno delay
-        vTaskDelay(pdMS_TO_TICKS(50));
+        if (errors) {
+            printf(" (%" PRIu32 " mensagens corrompidas)", errors);
+        }
+        printf("\n");
+        xport_payload_destroy(kind, handle);
     }
 }
 
-/* ========== MÓDULO 3: SUPERVISÃO ========== */
-void task_supervisor(void *pvParameters) {
-    int receiver_restart_count = 0;
+static void xport_benchmark(void) {
+    static const struct {
+        const char *name;
+        bool (*run)(xport_bench_result_t *result);
+    } impls[] = {
+        { "queue",  xport_bench_run_queue },
+        { "msgbuf", xport_bench_run_msgbuf },
+        { "stream", xport_bench_run_stream },
+        { "spsc",   xport_bench_run_spsc },
+        { "notify", xport_bench_run_notify },
+    };
     
-    printf("%s Módulo de Supervisão iniciado\n", TAG_SUP);
+    printf("%s Benchmark de transportes (%u mensagens por fase, capacidade %u, lotes de %u)\n",
+           TAG_MAIN, (unsigned int)XPORT_BENCH_MESSAGES, (unsigned int)XPORT_BENCH_LENGTH,
+           (unsigned int)XPORT_BENCH_BATCH);
+    for (size_t k = 0; k < sizeof(impls) / sizeof(impls[0]); k++) {
+        xport_bench_result_t result;
+        if (!impls[k].run(&result)) {
+            printf("%s   %-6s: sem memória\n", TAG_MAIN, impls[k].name);
+            continue;
+        }
+        printf("%s   %-6s: %.0f ns/msg unitário, %.0f ns/msg em lote, %.0f msg/s entre núcleos, "
+               "%" PRIu32 " B, pico %" PRIu32 ", %" PRIu32 " recusas, %" PRIu32 " erros\n",
+               TAG_MAIN, impls[k].name, result.single_ns, result.batch_ns, result.cross_msg_s,
+               result.stats.storage_bytes, result.stats.peak_depth, result.stats.full, result.errors);
+    }
+    
+    xport_payload_benchmark();
+}
+#endif
+
+/* ========== MICROBENCHMARKS ========== */
+#if MICROBENCH_ENABLED
+/* Cada amostra cronometra ops chamadas em ciclos de CPU; o custo do laço
+ * e da chamada indireta (op vazia) é descontado. prepare roda fora da
+ * medição, antes de cada amostra. */
+typedef struct {
+    const char *name;
+    void (*op)(int arg);
+    void (*prepare)(int arg);
+    int arg;
+    uint32_t ops;
+} mb_bench_t;
+
+typedef enum {
+    MB_ECHO_NOTIFY = 0,
+    MB_ECHO_QUEUE,
+    MB_ECHO_EVENTS,
+} mb_echo_mode_t;
+
+#define MB_EVT_PING             BIT0
+#define MB_EVT_PONG             BIT1
+
+static const size_t mb_item_sizes[] = { 4, 32, 128 };
+
+static struct {
+    QueueHandle_t queues[3];    // Um por tamanho de item em mb_item_sizes
+    QueueHandle_t ping;         // Ida e volta com a tarefa de eco
+    QueueHandle_t pong;
+    EventGroupHandle_t events;
+    TaskHandle_t main_task;
+    TaskHandle_t echo_task;
+    uint8_t item[128];
+    char line[80];
+} mb;
+
+static void mb_op_empty(int arg) {
+}
+
+static void mb_prepare_queue_empty(int arg) {
+    xQueueReset(mb.queues[arg]);
+}
+
+static void mb_prepare_queue_full(int arg) {
+    xQueueReset(mb.queues[arg]);
+    while (xQueueSend(mb.queues[arg], mb.item, 0) == pdTRUE) {
+    }
+}
+
+static void mb_op_queue_send(int arg) {
+    xQueueSend(mb.queues[arg], mb.item, 0);
+}
+
+static void mb_op_queue_receive(int arg) {
+    xQueueReceive(mb.queues[arg], mb.item, 0);
+}
+
+static void mb_op_events_set(int arg) {
+    xEventGroupSetBits(mb.events, BIT2);
+}
+
+static void mb_op_events_clear(int arg) {
+    xEventGroupClearBits(mb.events, BIT2);
+}
+
+// Sem tarefa esperando: só o custo de publicar (eNoAction não muda o valor)
+static void mb_op_notify(int arg) {
+    xTaskNotify(mb.main_task, 0, eNoAction);
+}
+
+static void mb_op_wdt_reset(int arg) {
+    esp_task_wdt_reset();
+}
+
+static void mb_op_malloc_free(int arg) {
+    void *volatile block = malloc((size_t)arg);
+    free(block);
+}
+
+static void mb_op_snprintf(int arg) {
+    snprintf(mb.line, sizeof(mb.line), "%s valor %d recebido na faixa %s", TAG_RCV, arg, lane_names[LANE_BULK]);
+}
+
+static void mb_op_printf(int arg) {
+    printf("%s valor %d recebido na faixa %s\n", TAG_RCV, arg, lane_names[LANE_BULK]);
+}
+
+// Ida e volta com a tarefa de eco (no mesmo núcleo ou no outro)
+static void mb_op_roundtrip(int arg) {
+    uint32_t token = 0;
+    
+    switch ((mb_echo_mode_t)arg) {
+        case MB_ECHO_NOTIFY:
+            xTaskNotifyGive(mb.echo_task);
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            break;
+        case MB_ECHO_QUEUE:
+            xQueueSend(mb.ping, &token, portMAX_DELAY);
+            xQueueReceive(mb.pong, &token, portMAX_DELAY);
+            break;
+        case MB_ECHO_EVENTS:
+            xEventGroupSetBits(mb.events, MB_EVT_PING);
+            xEventGroupWaitBits(mb.events, MB_EVT_PONG, pdTRUE, pdTRUE, portMAX_DELAY);
+            break;
+    }
+}
+
+static void mb_echo_task(void *pvParameters) {
+    mb_echo_mode_t mode = (mb_echo_mode_t)(intptr_t)pvParameters;
+    uint32_t token;
     
     for (;;) {
-        vTaskDelay(pdMS_TO_TICKS(SUPERVISOR_PERIOD_MS));
-        
-        // Lê as flags de status
-        EventBits_t flags = xEventGroupGetBits(status_flags);
-        
-        printf("\n%s ========== STATUS DO SISTEMA ==========\n", TAG_SUP);
-        
-        // Status do Gerador
-        if (flags & FLAG_GENERATOR_OK) {
-            printf("%s Módulo Gerador: [OK] - Funcionando normalmente\n", TAG_SUP);
-        } else {
-            printf("%s Módulo Gerador: [FALHA] - Sem resposta\n", TAG_SUP);
-        }
-        
-        // Status do Receptor
-        if (flags & FLAG_RECEIVER_OK) {
-            printf("%s Módulo Receptor: [OK] - Recebendo dados\n", TAG_SUP);
-        } else if (flags & FLAG_RECEIVER_WARNING) {
-            printf("%s Módulo Receptor: [AVISO] - Timeouts detectados\n", TAG_SUP);
-        } else if (flags & FLAG_RECEIVER_RECOVERY) {
-            printf("%s Módulo Receptor: [RECUPERAÇÃO] - Tentando recuperar\n", TAG_SUP);
-        } else if (flags & FLAG_RECEIVER_SHUTDOWN) {
-            printf("%s Módulo Receptor: [CRÍTICO] - Em processo de encerramento\n", TAG_SUP);
-        } else {
-            printf("%s Módulo Receptor: [DESCONHECIDO] - Status indeterminado\n", TAG_SUP);
+        switch (mode) {
+            case MB_ECHO_NOTIFY:
+                ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+                xTaskNotifyGive(mb.main_task);
+                break;
+            case MB_ECHO_QUEUE:
+                xQueueReceive(mb.ping, &token, portMAX_DELAY);
+                xQueueSend(mb.pong, &token, portMAX_DELAY);
+                break;
+            case MB_ECHO_EVENTS:
+                xEventGroupWaitBits(mb.events, MB_EVT_PING, pdTRUE, pdTRUE, portMAX_DELAY);
+                xEventGroupSetBits(mb.events, MB_EVT_PONG);
+                break;
         }
-        
-        // Informações de memória
-        size_t free_heap = xPortGetFreeHeapSize();
-        size_t min_heap = xPortGetMinimumEverFreeHeapSize();
-        printf("%s Memória livre: %u bytes (mínimo histórico: %u bytes)\n", 
-               TAG_MEM, (unsigned int)free_heap, (unsigned int)min_heap);
-        
-        printf("%s ========================================\n\n", TAG_SUP);
-        
-        // Verifica se precisa recriar tarefa do receptor
-        TickType_t now = xTaskGetTickCount();
-        if (receiver_task_handle == NULL || 
-            (now - receiver_heartbeat > pdMS_TO_TICKS(2 * SUPERVISOR_PERIOD_MS))) {
-            
-            printf("%s AÇÃO: Recriando tarefa do Receptor (tentativa %d)\n", 
-                   TAG_SUP, ++receiver_restart_count);
-            
-            if (receiver_task_handle != NULL) {
-                vTaskDelete(receiver_task_handle);
-                receiver_task_handle = NULL;
-            }
-            
-            xTaskCreatePinnedToCore(
-                task_data_receiver,
-                "receiver_task",
-                RECEIVER_STACK_SIZE,
-                NULL,
-                RECEIVER_TASK_PRIO,
-                &receiver_task_handle,
-                1
-            );
-            
-            receiver_heartbeat = xTaskGetTickCount();
-            xEventGroupClearBits(status_flags, FLAG_RECEIVER_WARNING | FLAG_RECEIVER_RECOVERY | FLAG_RECEIVER_SHUTDOWN);
-            
-            // Se falhou muitas vezes, reinicia o sistema
-            if (receiver_restart_count >= 5) {
-                printf("%s REINICIALIZAÇÃO CRÍTICA: Falhas excessivas detectadas\n", TAG_WDT);
-                printf("%s Reiniciando ESP32 em 1 segundo...\n", TAG_MAIN);
-                vTaskDelay(pdMS_TO_TICKS(1000));
-                esp_restart();
-            }
+    }
+}
+
+// ns/op de cada amostra, descontado baseline_ns; média, meia-largura do IC de 95% e mínimo
+static void mb_measure(const mb_bench_t *bench, double baseline_ns, double *mean, double *ci95, double *min) {
+    double samples[MICROBENCH_SAMPLES];
+    double ns_per_cycle = 1e9 / (double)esp_clk_cpu_freq();
+    double sum = 0.0;
+    
+    *min = INFINITY;
+    for (int r = 0; r < MICROBENCH_SAMPLES; r++) {
+        if (bench->prepare != NULL) {
+            bench->prepare(bench->arg);
         }
-        
-        // Verifica gerador
-        if (now - generator_heartbeat > pdMS_TO_TICKS(2 * SUPERVISOR_PERIOD_MS)) {
-            printf("%s AÇÃO: Recriando tarefa do Gerador\n", TAG_SUP);
-            
-            if (generator_task_handle != NULL) {
-                vTaskDelete(generator_task_handle);
-                generator_task_handle = NULL;
-            }
-            
-            xTaskCreatePinnedToCore(
-                task_data_generator,
-                "generator_task",
-                GENERATOR_STACK_SIZE,
-                NULL,
-                GENERATOR_TASK_PRIO,
-                &generator_task_handle,
-                1
-            );
-            
-            generator_heartbeat = xTaskGetTickCount();
+        uint32_t start = esp_cpu_get_cycle_count();
+        for (uint32_t i = 0; i < bench->ops; i++) {
+            bench->op(bench->arg);
         }
-        
-        // Alerta de memória crítica
-        if (min_heap < 10 * 1024) {
-            printf("%s ALERTA CRÍTICO: Memória mínima muito baixa!\n", TAG_MEM);
+        uint32_t cycles = esp_cpu_get_cycle_count() - start;
+        samples[r] = (double)cycles * ns_per_cycle / bench->ops - baseline_ns;
+        sum += samples[r];
+        if (samples[r] < *min) {
+            *min = samples[r];
+        }
+    }
+    
+    *mean = sum / MICROBENCH_SAMPLES;
+    double var = 0.0;
+    for (int r = 0; r < MICROBENCH_SAMPLES; r++) {
+        var += (samples[r] - *mean) * (samples[r] - *mean);
+    }
+    var /= MICROBENCH_SAMPLES - 1;
+    *ci95 = MICROBENCH_T95 * sqrt(var / MICROBENCH_SAMPLES);
+}
+
+static void mb_report(const mb_bench_t *bench, double baseline_ns) {
+    double mean, ci95, min;
+    mb_measure(bench, baseline_ns, &mean, &ci95, &min);
+    printf("%s   %-36s %9.1f ± %7.1f  (mín %.1f)\n", TAG_MAIN, bench->name, mean, ci95, min);
+}
+
+static void microbench_run(void) {
+    static const mb_bench_t benches[] = {
+        { "xQueueSend 4 B",                 mb_op_queue_send,    mb_prepare_queue_empty, 0,  MICROBENCH_QUEUE_LENGTH },
+        { "xQueueSend 32 B",                mb_op_queue_send,    mb_prepare_queue_empty, 1,  MICROBENCH_QUEUE_LENGTH },
+        { "xQueueSend 128 B",               mb_op_queue_send,    mb_prepare_queue_empty, 2,  MICROBENCH_QUEUE_LENGTH },
+        { "xQueueReceive 4 B",              mb_op_queue_receive, mb_prepare_queue_full,  0,  MICROBENCH_QUEUE_LENGTH },
+        { "xQueueReceive 32 B",             mb_op_queue_receive, mb_prepare_queue_full,  1,  MICROBENCH_QUEUE_LENGTH },
+        { "xQueueReceive 128 B",            mb_op_queue_receive, mb_prepare_queue_full,  2,  MICROBENCH_QUEUE_LENGTH },
+        { "xEventGroupSetBits",             mb_op_events_set,    NULL,                   0,  64 },
+        { "xEventGroupClearBits",           mb_op_events_clear,  NULL,                   0,  64 },
+        { "xTaskNotify (sem espera)",       mb_op_notify,        NULL,                   0,  64 },
+        { "esp_task_wdt_reset",             mb_op_wdt_reset,     NULL,                   0,  64 },
+        { "malloc+free 20 B",               mb_op_malloc_free,   NULL,                   20, 64 },
+        { "malloc+free 256 B",              mb_op_malloc_free,   NULL,                   256, 64 },
+        { "snprintf de uma linha",          mb_op_snprintf,      NULL,                   0,  16 },
+        { "printf de uma linha",            mb_op_printf,        NULL,                   0,  2 },
+    };
+    static const struct {
+        const char *name;
+        mb_echo_mode_t mode;
+    } echoes[] = {
+        { "xTaskNotifyGive",    MB_ECHO_NOTIFY },
+        { "xQueueSend/Receive", MB_ECHO_QUEUE },
+        { "xEventGroupSet/Wait", MB_ECHO_EVENTS },
+    };
+    static char echo_names[sizeof(echoes) / sizeof(echoes[0])][2][48];
+    
+    mb.main_task = xTaskGetCurrentTaskHandle();
+    mb.ping = xQueueCreate(1, sizeof(uint32_t));
+    mb.pong = xQueueCreate(1, sizeof(uint32_t));
+    mb.events = xEventGroupCreate();
+    bool ok = mb.ping != NULL && mb.pong != NULL && mb.events != NULL;
+    for (size_t i = 0; i < sizeof(mb_item_sizes) / sizeof(mb_item_sizes[0]); i++) {
+        mb.queues[i] = xQueueCreate(MICROBENCH_QUEUE_LENGTH, mb_item_sizes[i]);
+        ok = ok && mb.queues[i] != NULL;
+    }
+    if (!ok) {
+        printf("%s ERRO: Sem memória para os microbenchmarks\n", TAG_MAIN);
+        return;
+    }
+    
+    // Custo do laço e da chamada indireta, descontado de todas as medidas
+    const mb_bench_t empty = { "vazio", mb_op_empty, NULL, 0, 64 };
+    double baseline_ns, baseline_ci, baseline_min;
+    mb_measure(&empty, 0.0, &baseline_ns, &baseline_ci, &baseline_min);
+    
+    printf("%s Microbenchmarks (ns/op, média ± IC 95%%, %d amostras; base %.1f ns descontada)\n",
+           TAG_MAIN, MICROBENCH_SAMPLES, baseline_ns);
+    
+    esp_task_wdt_add(NULL);     // esp_task_wdt_reset() exige a tarefa inscrita
+    for (size_t k = 0; k < sizeof(benches) / sizeof(benches[0]); k++) {
+        mb_report(&benches[k], baseline_ns);
+    }
+    esp_task_wdt_delete(NULL);
+    
+    // Ida e volta: tarefa de eco com prioridade maior no mesmo núcleo e no outro
+    ulTaskNotifyTake(pdTRUE, 0);
+    BaseType_t core = xPortGetCoreID();
+    for (size_t e = 0; e < sizeof(echoes) / sizeof(echoes[0]); e++) {
+        for (int cross = 0; cross < 2; cross++) {
+            snprintf(echo_names[e][cross], sizeof(echo_names[e][cross]), "ida e volta %s, %s",
+                     echoes[e].name, cross ? "entre núcleos" : "mesmo núcleo");
+            if (xTaskCreatePinnedToCore(mb_echo_task, "mb_echo", 2048, (void *)(intptr_t)echoes[e].mode,
+                                        uxTaskPriorityGet(NULL) + 1, &mb.echo_task,
+                                        cross ? 1 - core : core) != pdPASS) {
+                continue;
+            }
+            const mb_bench_t bench = { echo_names[e][cross], mb_op_roundtrip, NULL, echoes[e].mode, 32 };
+            mb_report(&bench, baseline_ns);
+            vTaskDelete(mb.echo_task);
         }
     }
+    
+    for (size_t i = 0; i < sizeof(mb_item_sizes) / sizeof(mb_item_sizes[0]); i++) {
+        vQueueDelete(mb.queues[i]);
+    }
+    vQueueDelete(mb.ping);
+    vQueueDelete(mb.pong);
+    vEventGroupDelete(mb.events);
 }
+#endif
 
 /* ========== FUNÇÃO PRINCIPAL ========== */
 void app_main(void) {
@@ -296,14 +4916,26 @@ void app_main(void) {
     printf("%s Sistema Multitarefa FreeRTOS Iniciando...\n", TAG_MAIN);
     printf("=================================================\n\n");
     
-    // Cria a fila de comunicação
-    data_queue = xQueueCreate(QUEUE_LENGTH, QUEUE_ITEM_SIZE);
-    if (data_queue == NULL) {
+    // Parâmetros do NVS antes de dimensionar filas e tarefas
+    cfg_load();
+    
+    // Tabelas de CRC32 usadas pelo gerador, receptor e transmissor
+    crc32_init();
+#if CRC_BENCHMARK_ENABLED
+    crc32_benchmark();
+#endif
+#if XPORT_BENCHMARK_ENABLED
+    xport_benchmark();
+#endif
+    
+    // Cria as faixas, o canal de controle e a espera única do receptor
+    if (!lanes_init() || !ctl_init() || !rx_wait_init()) {
         printf("%s ERRO FATAL: Falha ao criar fila\n", TAG_QUEUE);
         printf("%s Reiniciando sistema...\n", TAG_MAIN);
         esp_restart();
     }
-    printf("%s Fila criada com sucesso (capacidade: %d itens)\n", TAG_QUEUE, QUEUE_LENGTH);
+    printf("%s Faixas criadas com sucesso (capacidade: urgente %" PRId32 ", bulk %" PRId32 " itens)\n",
+           TAG_QUEUE, cfg_get(CFG_URGENT_LENGTH), cfg_get(CFG_QUEUE_LENGTH));
     
     // Cria o Event Group para flags de status
     status_flags = xEventGroupCreate();
@@ -314,6 +4946,14 @@ void app_main(void) {
     }
     printf("%s Event Group criado com sucesso\n", TAG_MAIN);
     
+    // Prepara os buffers e o sink do estágio de transmissão
+    if (!transmitter_init()) {
+        printf("%s ERRO FATAL: Falha ao inicializar o estágio de transmissão\n", TAG_TX);
+        printf("%s Reiniciando sistema...\n", TAG_MAIN);
+        esp_restart();
+    }
+    printf("%s Transmissão configurada (%d buffers de %d valores)\n", TAG_TX, TX_NUM_BUFFERS, TX_BATCH_SIZE);
+    
     // Configura e inicializa o Watchdog Timer
     esp_task_wdt_config_t twdt_config = {
         .timeout_ms = TWDT_TIMEOUT_S * 1000,
@@ -328,41 +4968,126 @@ void app_main(void) {
         printf("%s AVISO: Falha ao configurar Watchdog Timer\n", TAG_WDT);
     }
     
+#if MICROBENCH_ENABLED
+    // Com o TWDT pronto e antes do DFS, que mudaria o clock no meio das medidas
+    microbench_run();
+#endif
+    
+    // Contagem de despertares e, no baixo consumo, DFS + light sleep e liveness por timer
+    if (!power_init()) {
+        printf("%s AVISO: Falha ao configurar o gerenciamento de energia\n", TAG_MAIN);
+    }
+#if LOW_POWER_ENABLED
+    if (!liveness_timer_start()) {
+        printf("%s AVISO: Falha ao iniciar o timer do agente de liveness\n", TAG_WDT);
+    }
+    printf("%s Baixo consumo: DFS %d-%d MHz, light sleep %s, liveness por timer a cada %d ms\n",
+           TAG_MAIN, LOW_POWER_MIN_FREQ_MHZ, LOW_POWER_MAX_FREQ_MHZ,
+           LOW_POWER_LIGHT_SLEEP ? "ligado" : "desligado", LIVENESS_CHECK_PERIOD_MS);
+#endif
+    
     // Cria as tarefas
+#if TRACE_RECORDER_ENABLED
+    // Nomeia os objetos do pipeline e começa a gravar a timeline
+#if LANE_TRANSPORT == LANE_TRANSPORT_QUEUE || LANE_TRANSPORT == LANE_TRANSPORT_MSGBUF || \
+    LANE_TRANSPORT == LANE_TRANSPORT_STREAM
+    trace_name_object(lane_xports[LANE_URGENT].handle, "lane_urgent");
+    trace_name_object(lane_xports[LANE_BULK].handle, "lane_bulk");
+#endif
+    trace_name_object(lane_doorbell, "lane_doorbell");
+    trace_name_object(ctl_queues[LIVENESS_GENERATOR], "ctl_generator");
+    trace_name_object(ctl_queues[LIVENESS_RECEIVER], "ctl_receiver");
+    trace_name_object(ctl_ack_queue, "ctl_ack_queue");
+    trace_name_object(rx_wait_set, "rx_wait_set");
+    trace_name_object(status_flags, "status_flags");
+    trace_name_object(tx_free_queue, "tx_free_queue");
+    trace_name_object(tx_ready_queue, "tx_ready_queue");
+    trace_enabled = true;
+    printf("%s Gravador de trace ativo (%d eventos por núcleo)\n", TAG_MAIN, TRACE_RING_EVENTS);
+#endif
+    
     printf("\n%s Criando tarefas do sistema...\n", TAG_MAIN);
     
+#if GEN_SOURCE == GEN_SOURCE_TIMER
+    // Gerador sem tarefa: o alarme do gptimer produz os valores
+    heartbeat_beat(&generator_heartbeat);
+    if (!gen_timer_start()) {
+        printf("%s ERRO FATAL: Falha ao iniciar o timer do gerador\n", TAG_GEN);
+        printf("%s Reiniciando sistema...\n", TAG_MAIN);
+        esp_restart();
+    }
+    printf("%s Gerador por timer iniciado (período %" PRIu32 " us, sem tarefa)\n", TAG_MAIN, gen_timer_period());
+#else
     xTaskCreatePinnedToCore(
         task_data_generator,
         "generator_task",
-        GENERATOR_STACK_SIZE,
+        cfg_get(CFG_GENERATOR_STACK),
         NULL,
-        GENERATOR_TASK_PRIO,
+        cfg_get(CFG_GENERATOR_PRIO),
         &generator_task_handle,
         1  // Core 1
     );
-    printf("%s Tarefa Gerador criada (Core 1, Prioridade %d)\n", TAG_MAIN, GENERATOR_TASK_PRIO);
+    printf("%s Tarefa Gerador criada (Core 1, Prioridade %" PRId32 ")\n", TAG_MAIN, cfg_get(CFG_GENERATOR_PRIO));
+#endif
     
     xTaskCreatePinnedToCore(
         task_data_receiver,
         "receiver_task",
-        RECEIVER_STACK_SIZE,
+        cfg_get(CFG_RECEIVER_STACK),
         NULL,
-        RECEIVER_TASK_PRIO,
+        cfg_get(CFG_RECEIVER_PRIO),
         &receiver_task_handle,
         1  // Core 1
     );
-    printf("%s Tarefa Receptor criada (Core 1, Prioridade %d)\n", TAG_MAIN, RECEIVER_TASK_PRIO);
+    printf("%s Tarefa Receptor criada (Core 1, Prioridade %" PRId32 ")\n", TAG_MAIN, cfg_get(CFG_RECEIVER_PRIO));
     
     xTaskCreatePinnedToCore(
         task_supervisor,
         "supervisor_task",
-        SUPERVISOR_STACK_SIZE,
-        NULL,
-        SUPERVISOR_TASK_PRIO,
+        cfg_get(CFG_SUPERVISOR_STACK),
         NULL,
+        cfg_get(CFG_SUPERVISOR_PRIO),
+        &supervisor_task_handle,
         0  // Core 0
     );
-    printf("%s Tarefa Supervisor criada (Core 0, Prioridade %d)\n", TAG_MAIN, SUPERVISOR_TASK_PRIO);
+    printf("%s Tarefa Supervisor criada (Core 0, Prioridade %" PRId32 ")\n", TAG_MAIN, cfg_get(CFG_SUPERVISOR_PRIO));
+    
+    xTaskCreatePinnedToCore(
+        task_transmitter,
+        "transmitter_task",
+        cfg_get(CFG_TRANSMITTER_STACK),
+        NULL,
+        cfg_get(CFG_TRANSMITTER_PRIO),
+        &transmitter_task_handle,
+        0  // Core 0, fora do caminho de dados
+    );
+    printf("%s Tarefa Transmissor criada (Core 0, Prioridade %" PRId32 ")\n", TAG_MAIN, cfg_get(CFG_TRANSMITTER_PRIO));
+    
+    xTaskCreatePinnedToCore(
+        task_console,
+        "console_task",
+        CONSOLE_TASK_STACK_SIZE,
+        NULL,
+        CONSOLE_TASK_PRIO,
+        &console_task_handle,
+        0  // Core 0, fora do caminho de dados
+    );
+    printf("%s Tarefa Console criada (Core 0, Prioridade %d; comandos: cfg, ctl%s)\n", TAG_MAIN, CONSOLE_TASK_PRIO,
+           FAULT_INJECTION_ENABLED ? ", fault" : "");
+    
+#if FAULT_INJECTION_ENABLED
+    fault_cmd_queue = xQueueCreate(1, sizeof(uint8_t));
+    xTaskCreatePinnedToCore(
+        task_fault_injector,
+        "fault_task",
+        FAULT_TASK_STACK_SIZE,
+        NULL,
+        FAULT_TASK_PRIO,
+        &fault_task_handle,
+        0  // Core 0, fora do caminho de dados
+    );
+    printf("%s Tarefa de Injeção de Falhas criada (Core 0, Prioridade %d)\n", TAG_MAIN, FAULT_TASK_PRIO);
+#endif
     
     printf("\n%s Todas as tarefas criadas com sucesso!\n", TAG_MAIN);
     printf("%s Sistema em execução...\n\n", TAG_MAIN);
@@ -0,0 +1,287 @@
+#!/usr/bin/env python3
+"""Autotuner de fila, taxas e prioridades por simulação de eventos discretos.
+
+Simula o núcleo 1 (gerador e receptor de main.c) com escalonamento
+preemptivo por prioridade, ticks do FreeRTOS e o custo dos printf no console
+(a UART do console escreve em espera ativa, então cada caractere ocupa a
+CPU). O supervisor roda no núcleo 0 e só entra no modelo pelo relatório
+periódico, que ocupa o console compartilhado e bloqueia os printf do núcleo 1
+- é o que a fila precisa absorver. O transmissor não entra no modelo.
+
+Cada configuração roda por uma duração virtual fixa e gera vazão, taxa de
+descarte, latência p99 (envio -> recepção) e RAM (fila + pilhas). O
+resultado é a fronteira de Pareto dessas quatro métricas e, com
+--target-rate, a configuração recomendada, na forma de comandos "cfg set"
+para o console.
+
+Uso:
+    python3 tools/autotune.py --target-rate 20
+    python3 tools/autotune.py --periods 20,50,100,200 --duration 60 --all
+"""
+import argparse
+import itertools
+import math
+
+# Custos no alvo (ESP32 a 240 MHz, console a 115200 baud 8N1)
+CONSOLE_US_PER_CHAR = 10 * 1e6 / 115200
+GEN_WORK_US = 25                # CRC + montagem da mensagem
+RCV_WORK_US = 40                # malloc/free + CRC + tx_enqueue
+GEN_SENT_CHARS = 48 + 62        # "Dado enviado..." + "Valor N gerado..."
+GEN_DROP_CHARS = 42 + 66        # "Fila cheia..." + "AVISO: Valor N descartado..."
+RCV_RECV_CHARS = 46             # "Dado recebido da fila"
+RCV_TIMEOUT_CHARS = 80 + 60     # "TIMEOUT..." + linha do nível
+
+MSG_SIZE = 16                   # sizeof(data_msg_t)
+QUEUE_OVERHEAD = 80             # Estrutura da fila do FreeRTOS
+TCB_SIZE = 350
+DEFAULT_STACKS = 3072 + 4096    # Gerador + receptor
+
+
+class Task:
+    def __init__(self, name, prio, body):
+        self.name = name
+        self.prio = prio
+        self.body = body
+        self.cpu_left = 0.0
+        self.wake_us = None     # Bloqueada até este instante (None = pronta)
+        self.waiting_recv = False
+        self.reply = None
+
+
+class Sim:
+    """Núcleo único com preempção por prioridade e fila de tamanho fixo."""
+
+    def __init__(self, cfg, tick_us):
+        self.cfg = cfg
+        self.tick_us = tick_us
+        self.now = 0.0
+        self.queue = []
+        self.sent = self.dropped = self.received = self.timeouts = 0
+        self.latencies = []
+
+    def tick_deadline(self, ticks):
+        # vTaskDelay(n) acorda no n-ésimo tick a partir do atual
+        return (math.floor(self.now / self.tick_us) + ticks) * self.tick_us
+
+    def console_free_at(self):
+        # Relatório do supervisor a cada sup_period ocupa o console por report_chars
+        period_us = self.cfg["sup_period"] * 1000
+        busy_us = self.cfg["report_chars"] * CONSOLE_US_PER_CHAR
+        phase = self.now % period_us
+        return self.now - phase + busy_us if phase < busy_us else None
+
+    def generator(self):
+        period = max(1, round(self.cfg["gen_period"] * 1000 / self.tick_us))
+        while True:
+            yield ("cpu", GEN_WORK_US)
+            ok = yield ("send", self.now)
+            yield ("print", GEN_SENT_CHARS if ok else GEN_DROP_CHARS)
+            yield ("delay", period)
+
+    def receiver(self):
+        delay = round(self.cfg["rcv_delay"] * 1000 / self.tick_us)
+        timeout = max(1, round(self.cfg["recv_tmo"] * 1000 / self.tick_us))
+        while True:
+            msg = yield ("recv", timeout)
+            if msg is not None:
+                self.received += 1
+                self.latencies.append(self.now - msg)
+                yield ("cpu", RCV_WORK_US)
+                yield ("print", RCV_RECV_CHARS)
+            else:
+                self.timeouts += 1
+                yield ("print", RCV_TIMEOUT_CHARS)
+            yield ("delay", delay)
+
+    def step(self, task):
+        """Avança a tarefa até ela ter CPU a consumir ou bloquear."""
+        while task.cpu_left <= 0 and task.wake_us is None:
+            action, arg = task.body.send(task.reply)
+            task.reply = None
+            if action == "cpu":
+                task.cpu_left = arg
+            elif action == "print":
+                # Espera o lock do console e depois escreve em espera ativa
+                task.cpu_left = arg * CONSOLE_US_PER_CHAR
+                task.wake_us = self.console_free_at()
+            elif action == "send":
+                waiting = [t for t in self.tasks if t.waiting_recv]
+                if waiting:
+                    # Entrega direta a quem espera na fila
+                    waiting[0].waiting_recv = False
+                    waiting[0].wake_us = None
+                    waiting[0].reply = arg
+                    task.reply = True
+                elif len(self.queue) < self.cfg["queue_len"]:
+                    self.queue.append(arg)
+                    task.reply = True
+                else:
+                    task.reply = False
+                self.sent += task.reply
+                self.dropped += not task.reply
+            elif action == "recv":
+                if self.queue:
+                    task.reply = self.queue.pop(0)
+                else:
+                    task.waiting_recv = True
+                    task.wake_us = self.tick_deadline(arg)
+            elif action == "delay":
+                if arg > 0:
+                    task.wake_us = self.tick_deadline(arg)
+
+    def run(self, duration_s):
+        gen = Task("gerador", self.cfg["gen_prio"], self.generator())
+        rcv = Task("receptor", self.cfg["rcv_prio"], self.receiver())
+        self.tasks = [gen, rcv]
+        end_us = duration_s * 1e6
+
+        while self.now < end_us:
+            for task in self.tasks:
+                if task.wake_us is not None and task.wake_us <= self.now:
+                    task.wake_us = None
+                    task.waiting_recv = False
+
+            ready = [t for t in self.tasks if t.wake_us is None]
+            if not ready:
+                self.now = min(t.wake_us for t in self.tasks)
+                continue
+
+            # Maior prioridade roda; empate: o primeiro da lista (gerador)
+            running = max(ready, key=lambda t: t.prio)
+            if running.cpu_left <= 0:
+                # Ações instantâneas podem bloquear a tarefa ou acordar outra
+                self.step(running)
+                continue
+
+            horizon = min([self.now + running.cpu_left] +
+                          [t.wake_us for t in self.tasks
+                           if t.wake_us is not None and t.prio > running.prio])
+            if horizon >= self.now + running.cpu_left:
+                running.cpu_left = 0
+            else:
+                running.cpu_left -= horizon - self.now
+            self.now = horizon
+        return self
+
+
+def percentile(values, p):
+    if not values:
+        return float("nan")
+    ordered = sorted(values)
+    return ordered[min(len(ordered) - 1, int(len(ordered) * p / 100))]
+
+
+def evaluate(cfg, duration_s, tick_us):
+    sim = Sim(cfg, tick_us).run(duration_s)
+    generated = sim.sent + sim.dropped
+    return {
+        "throughput": sim.received / duration_s,
+        "drop_rate": sim.dropped / generated if generated else 0.0,
+        "p99_ms": percentile(sim.latencies, 99) / 1000,
+        "ram": cfg["queue_len"] * MSG_SIZE + QUEUE_OVERHEAD + DEFAULT_STACKS + 2 * TCB_SIZE,
+    }
+
+
+def dominates(a, b):
+    better_or_equal = (a["throughput"] >= b["throughput"] and a["drop_rate"] <= b["drop_rate"] and
+                       a["p99_ms"] <= b["p99_ms"] and a["ram"] <= b["ram"])
+    strictly = (a["throughput"] > b["throughput"] or a["drop_rate"] < b["drop_rate"] or
+                a["p99_ms"] < b["p99_ms"] or a["ram"] < b["ram"])
+    return better_or_equal and strictly
+
+
+def pareto(results):
+    return [r for r in results if not any(dominates(o["metrics"], r["metrics"]) for o in results)]
+
+
+def print_table(title, results):
+    print(title)
+    print("  fila período atraso prio(g/r)   msg/s  descarte  p99 ms   RAM B")
+    for r in sorted(results, key=lambda r: (-r["metrics"]["throughput"], r["metrics"]["ram"])):
+        c, m = r["cfg"], r["metrics"]
+        print("  %4d %7d %6d %5d/%-3d %8.2f %8.2f%% %7.1f %7d" % (
+            c["queue_len"], c["gen_period"], c["rcv_delay"], c["gen_prio"], c["rcv_prio"],
+            m["throughput"], 100 * m["drop_rate"], m["p99_ms"], m["ram"]))
+
+
+def on_target(results, target_rate, max_drop, tolerance):
+    """Configurações que entregam a taxa alvo (sem exceder) dentro do descarte aceito."""
+    return [r for r in results
+            if abs(r["metrics"]["throughput"] - target_rate) <= target_rate * tolerance and
+            r["metrics"]["drop_rate"] <= max_drop]
+
+
+def recommend(frontier):
+    # Empate: o maior atraso do receptor deixa mais CPU livre no núcleo 1
+    return min(frontier, key=lambda r: (r["metrics"]["ram"], r["metrics"]["p99_ms"],
+                                        r["metrics"]["drop_rate"], -r["cfg"]["rcv_delay"]))
+
+
+def int_list(text):
+    return [int(v) for v in text.split(",")]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--target-rate", type=float, help="taxa desejada (msg/s); define os períodos varridos")
+    parser.add_argument("--queue-lens", type=int_list, default=[2, 4, 6, 8, 10, 16, 32])
+    parser.add_argument("--periods", type=int_list, default=[20, 50, 100, 200, 500], help="ms")
+    parser.add_argument("--rcv-delays", type=int_list, default=[0, 10, 20, 50], help="ms")
+    parser.add_argument("--prios", default="5/4,4/5,5/5", help="pares gerador/receptor")
+    parser.add_argument("--recv-tmo", type=int, default=2000, help="ms")
+    parser.add_argument("--sup-period", type=int, default=3000, help="ms entre relatórios do supervisor")
+    parser.add_argument("--report-chars", type=int, default=1800, help="tamanho do relatório (0 = ignora)")
+    parser.add_argument("--duration", type=float, default=30.0, help="segundos virtuais por configuração")
+    parser.add_argument("--tick-hz", type=int, default=100, help="CONFIG_FREERTOS_HZ")
+    parser.add_argument("--max-drop", type=float, default=0.01, help="descarte máximo aceito")
+    parser.add_argument("--tolerance", type=float, default=0.05, help="desvio aceito da taxa alvo")
+    parser.add_argument("--all", action="store_true", help="mostra todas as configurações")
+    args = parser.parse_args()
+
+    prios = [tuple(int(p) for p in pair.split("/")) for pair in args.prios.split(",")]
+    tick_us = 1e6 / args.tick_hz
+    periods = args.periods
+    if args.target_rate:
+        # O período nominal não basta: vTaskDelay é relativo e o console atrasa o
+        # gerador. Varre de metade do nominal até ele, em múltiplos do tick.
+        tick_ms = tick_us / 1000
+        nominal_ticks = max(1, round(1000 / args.target_rate / tick_ms))
+        periods = [round(t * tick_ms) for t in range(max(1, nominal_ticks // 2), nominal_ticks + 1)]
+
+    results = []
+    for queue_len, period, delay, (gen_prio, rcv_prio) in itertools.product(
+            args.queue_lens, periods, args.rcv_delays, prios):
+        cfg = {"queue_len": queue_len, "gen_period": period, "rcv_delay": delay,
+               "gen_prio": gen_prio, "rcv_prio": rcv_prio, "recv_tmo": args.recv_tmo,
+               "sup_period": args.sup_period, "report_chars": args.report_chars}
+        results.append({"cfg": cfg, "metrics": evaluate(cfg, args.duration, tick_us)})
+
+    if args.all:
+        print_table("Todas as configurações:", results)
+        print()
+    frontier = pareto(results)
+    print_table("Fronteira de Pareto (vazão x descarte x p99 x RAM): %d de %d" % (
+        len(frontier), len(results)), frontier)
+    if not args.target_rate:
+        return
+
+    feasible = on_target(results, args.target_rate, args.max_drop, args.tolerance)
+    print()
+    if not feasible:
+        print("Nenhuma configuração entrega %.1f msg/s (+-%.0f%%) com descarte <= %.1f%%" % (
+            args.target_rate, 100 * args.tolerance, 100 * args.max_drop))
+        raise SystemExit(1)
+    frontier = pareto(feasible)
+    print_table("Fronteira na taxa alvo: %d de %d" % (len(frontier), len(feasible)), frontier)
+
+    best = recommend(frontier)
+    c, m = best["cfg"], best["metrics"]
+    print()
+    print("Recomendada para %.1f msg/s: %.2f msg/s, %.2f%% descarte, p99 %.1f ms, %d B" % (
+        args.target_rate, m["throughput"], 100 * m["drop_rate"], m["p99_ms"], m["ram"]))
+    for key in ("queue_len", "gen_period", "rcv_delay", "gen_prio", "rcv_prio"):
+        print("  cfg set %s %d" % (key, c[key]))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,178 @@
+#!/usr/bin/env python3
+"""Benchmark de ida e volta do codec delta (TX_CODEC_DELTA) no host.
+
+Codifica fluxos sintéticos com a mesma lógica de codec_encode_frame() em
+main.c, decodifica com tools/frame_decoder.py e confere que os valores
+voltam idênticos. Reporta a razão de compressão frente a registros int32
+brutos e o custo de codificação e decodificação por valor (no host, em
+Python: serve para comparar fluxos e parâmetros, não como custo no alvo).
+
+Uso:
+    python3 tools/codec_bench.py [--values 100000] [--batch 16] [--loss 0.01]
+"""
+import argparse
+import random
+import struct
+import time
+import zlib
+
+from frame_decoder import FrameDecoder
+
+FRAME_MTU = 256
+CRC_SIZE = 4
+DELTA_HEADER_SIZE = 8
+VARINT_MAX = 5
+KEYFRAME_INTERVAL = 8
+RAW_FRAME_OVERHEAD = 10
+
+
+def zigzag(v):
+    return ((v << 1) ^ (v >> 31)) & 0xFFFFFFFF
+
+
+def to_int32(v):
+    v &= 0xFFFFFFFF
+    return v - (1 << 32) if v & 0x80000000 else v
+
+
+def varint(v):
+    out = bytearray()
+    while v >= 0x80:
+        out.append((v & 0x7F) | 0x80)
+        v >>= 7
+    out.append(v)
+    return out
+
+
+class DeltaEncoder:
+    """Espelho de delta_codec_t / codec_encode_frame()."""
+
+    def __init__(self, mtu=FRAME_MTU, keyframe_interval=KEYFRAME_INTERVAL):
+        self.mtu = mtu
+        self.keyframe_interval = keyframe_interval
+        self.prev = 0
+        self.last_delta = 0
+        self.seq = 0
+        self.frames_since_key = 0
+
+    def encode_frame(self, values):
+        limit = self.mtu - CRC_SIZE
+        keyframe = self.frames_since_key == 0
+        if keyframe:
+            self.prev = 0
+            self.last_delta = 0
+        tokens = bytearray()
+        run = 0
+        n = 0
+        while n < len(values) and DELTA_HEADER_SIZE + len(tokens) + 2 * VARINT_MAX <= limit:
+            delta = to_int32(values[n] - self.prev)
+            if delta == self.last_delta:
+                run += 1
+            else:
+                if run:
+                    tokens += varint((run << 1) | 1)
+                    run = 0
+                tokens += varint(zigzag(delta) << 1)
+                self.last_delta = delta
+            self.prev = values[n]
+            n += 1
+        if run:
+            tokens += varint((run << 1) | 1)
+
+        body = struct.pack("<HHBB", len(tokens), n, self.seq, 1 if keyframe else 0) + tokens
+        self.seq = (self.seq + 1) & 0xFF
+        self.frames_since_key = (self.frames_since_key + 1) % self.keyframe_interval
+        return b"\xa5\x5c" + body + struct.pack("<I", zlib.crc32(body)), n
+
+    def encode_batch(self, values):
+        frames = []
+        first = 0
+        while first < len(values):
+            frame, consumed = self.encode_frame(values[first:])
+            frames.append(frame)
+            first += consumed
+        return frames
+
+
+def stream_sequential(count, rng):
+    return list(range(1, count + 1))
+
+
+def stream_slow_sensor(count, rng):
+    value, out = 2500, []
+    for _ in range(count):
+        if rng.random() < 0.2:
+            value += rng.choice((-1, 1))
+        out.append(value)
+    return out
+
+
+def stream_noisy(count, rng):
+    return [rng.randint(-1000, 1000) for _ in range(count)]
+
+
+def stream_random32(count, rng):
+    return [rng.randint(-2**31, 2**31 - 1) for _ in range(count)]
+
+
+STREAMS = {
+    "sequencial": stream_sequential,
+    "sensor_lento": stream_slow_sensor,
+    "ruido_1000": stream_noisy,
+    "aleatorio_32": stream_random32,
+}
+
+
+def run(name, values, batch, loss, rng):
+    encoder = DeltaEncoder()
+    frames = []
+    t0 = time.perf_counter()
+    for first in range(0, len(values), batch):
+        frames += encoder.encode_batch(values[first:first + batch])
+    encode_s = time.perf_counter() - t0
+
+    wire_bytes = sum(len(f) for f in frames)
+    raw_bytes = len(values) * 4 + -(-len(values) // batch) * RAW_FRAME_OVERHEAD
+
+    # Perda opcional de quadros para exercitar a ressincronização por keyframe
+    delivered = [f for f in frames if rng.random() >= loss]
+    decoder = FrameDecoder()
+    t0 = time.perf_counter()
+    decoded = []
+    for frame in delivered:
+        for chunk in decoder.feed(frame):
+            decoded += chunk
+    decode_s = time.perf_counter() - t0
+
+    if loss == 0:
+        status = "OK" if decoded == values else "FALHA"
+    else:
+        # Com perdas, o que foi entregue deve ser uma subsequência exata
+        it = iter(values)
+        status = "OK" if all(v in it for v in decoded) else "FALHA"
+
+    print("%-13s %8d valores  %7.2f:1 vs int32  %6.2f:1 vs quadro bruto  %5.2f B/valor  "
+          "cod %6.2f us/valor  dec %6.2f us/valor  perdidos %d  ida-volta %s" % (
+              name, len(values), len(values) * 4 / wire_bytes, raw_bytes / wire_bytes,
+              wire_bytes / len(values), encode_s * 1e6 / len(values),
+              decode_s * 1e6 / len(values), decoder.lost_records, status))
+    return status == "OK"
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--values", type=int, default=100000)
+    parser.add_argument("--batch", type=int, default=16, help="TX_BATCH_SIZE")
+    parser.add_argument("--loss", type=float, default=0.0, help="fração de quadros perdidos")
+    parser.add_argument("--seed", type=int, default=1)
+    args = parser.parse_args()
+
+    rng = random.Random(args.seed)
+    ok = True
+    for name, make in STREAMS.items():
+        ok &= run(name, make(args.values, rng), args.batch, args.loss, rng)
+    raise SystemExit(0 if ok else 1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,221 @@
+#!/usr/bin/env python3
+"""Decodificador dos quadros binários do transmissor (TX_FORMAT_BINARY).
+
+Formatos (little-endian), iguais aos de main.c:
+
+    bruto (TX_CODEC_NONE):
+        sync (A5 5A) | len u16 | count u16 | count * int32 | crc32 u32
+    delta (TX_CODEC_DELTA):
+        sync (A5 5C) | len u16 | count u16 | seq u8 | flags u8 | tokens | crc32 u32
+
+O CRC32 (IEEE, o mesmo de zlib.crc32) cobre tudo entre o sync e o CRC.
+Tokens delta são varints: t par -> delta = unzigzag(t >> 1); t ímpar ->
+repete o último delta (t >> 1) vezes. Após uma perda (CRC inválido ou
+salto de seq) o decodificador descarta quadros até o próximo keyframe.
+Bytes fora de um quadro válido são descartados até o próximo sync, assim
+como um sync cujo cabeçalho declara um quadro maior que TX_FRAME_MTU.
+
+Uso:
+    python3 tools/frame_decoder.py captura.bin
+    python3 tools/frame_decoder.py --serial /dev/ttyUSB1 --baud 921600
+    cat captura.bin | python3 tools/frame_decoder.py -
+"""
+import argparse
+import struct
+import sys
+import zlib
+
+SYNC_0 = 0xA5
+SYNC_1_RAW = 0x5A
+SYNC_1_DELTA = 0x5C
+RAW_HEADER_SIZE = 6
+DELTA_HEADER_SIZE = 8
+CRC_SIZE = 4
+RECORD_SIZE = 4
+FRAME_MTU = 256  # TX_FRAME_MTU em main.c: nenhum quadro válido é maior
+FLAG_KEYFRAME = 0x01
+
+
+def unzigzag(v):
+    return (v >> 1) ^ -(v & 1)
+
+
+def to_int32(v):
+    v &= 0xFFFFFFFF
+    return v - (1 << 32) if v & 0x80000000 else v
+
+
+def read_varint(data, pos):
+    result = 0
+    shift = 0
+    while True:
+        if pos >= len(data):
+            raise ValueError("varint truncado")
+        byte = data[pos]
+        pos += 1
+        result |= (byte & 0x7F) << shift
+        if byte < 0x80:
+            return result, pos
+        shift += 7
+        if shift > 35:
+            raise ValueError("varint longo demais")
+
+
+class DeltaState:
+    """Estado do decodificador delta, mantido entre quadros."""
+
+    def __init__(self):
+        self.synced = False
+        self.prev = 0
+        self.last_delta = 0
+        self.expected_seq = None
+
+    def decode(self, tokens, count, seq, flags):
+        """Retorna os valores do quadro, ou None se ainda fora de sincronia."""
+        if flags & FLAG_KEYFRAME:
+            self.synced = True
+            self.prev = 0
+            self.last_delta = 0
+        elif self.expected_seq is not None and seq != self.expected_seq:
+            self.synced = False
+        self.expected_seq = (seq + 1) & 0xFF
+        if not self.synced:
+            return None
+
+        values = []
+        pos = 0
+        while pos < len(tokens):
+            token, pos = read_varint(tokens, pos)
+            if token & 1:
+                repeat = token >> 1
+            else:
+                self.last_delta = unzigzag(token >> 1)
+                repeat = 1
+            for _ in range(repeat):
+                self.prev = to_int32(self.prev + self.last_delta)
+                values.append(self.prev)
+        if len(values) != count:
+            self.synced = False
+            raise ValueError("contagem divergente: %d != %d" % (len(values), count))
+        return values
+
+
+class FrameDecoder:
+    """Decodificador incremental: alimente bytes com feed() e receba quadros."""
+
+    def __init__(self):
+        self.buffer = bytearray()
+        self.delta = DeltaState()
+        self.frames = 0
+        self.records = 0
+        self.crc_errors = 0
+        self.lost_records = 0
+        self.discarded_bytes = 0
+        self.total_bytes = 0
+
+    def _drop(self, n):
+        self.discarded_bytes += n
+        del self.buffer[:n]
+
+    def feed(self, data):
+        self.buffer += data
+        self.total_bytes += len(data)
+        frames = []
+        while True:
+            start = self.buffer.find(bytes([SYNC_0]))
+            if start < 0:
+                self._drop(len(self.buffer))
+                break
+            if start > 0:
+                self._drop(start)
+            if len(self.buffer) < 2:
+                break
+            kind = self.buffer[1]
+            if kind not in (SYNC_1_RAW, SYNC_1_DELTA):
+                self._drop(1)
+                continue
+
+            header_size = RAW_HEADER_SIZE if kind == SYNC_1_RAW else DELTA_HEADER_SIZE
+            if len(self.buffer) < header_size:
+                break
+            length, count = struct.unpack_from("<HH", self.buffer, 2)
+            frame_size = header_size + length + CRC_SIZE
+            if frame_size > FRAME_MTU or (kind == SYNC_1_RAW and length != count * RECORD_SIZE):
+                # Cabeçalho inconsistente: falso sync, avança um byte em vez
+                # de esperar um corpo que o firmware nunca enviaria
+                self._drop(1)
+                continue
+
+            if len(self.buffer) < frame_size:
+                break
+
+            body = bytes(self.buffer[2:header_size + length])
+            (crc,) = struct.unpack_from("<I", self.buffer, header_size + length)
+            if zlib.crc32(body) != crc:
+                self.crc_errors += 1
+                self.delta.synced = False
+                self._drop(1)
+                continue
+            del self.buffer[:frame_size]
+
+            if kind == SYNC_1_RAW:
+                values = list(struct.unpack_from("<%di" % count, body, 4))
+            else:
+                seq, flags = body[4], body[5]
+                try:
+                    values = self.delta.decode(body[6:], count, seq, flags)
+                except ValueError:
+                    values = None
+                if values is None:
+                    self.lost_records += count
+                    continue
+
+            self.frames += 1
+            self.records += count
+            frames.append(values)
+        return frames
+
+    def summary(self):
+        per_value = self.total_bytes / self.records if self.records else 0.0
+        return ("quadros=%d registros=%d perdidos=%d erros_crc=%d bytes_descartados=%d "
+                "bytes=%d (%.2f B/valor)" % (self.frames, self.records, self.lost_records,
+                                             self.crc_errors, self.discarded_bytes,
+                                             self.total_bytes, per_value))
+
+
+def open_source(args):
+    if args.serial:
+        import serial  # pyserial, apenas para leitura direta da UART
+        return serial.Serial(args.serial, args.baud, timeout=1)
+    if args.input == "-":
+        return sys.stdin.buffer
+    return open(args.input, "rb")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("input", nargs="?", default="-", help="arquivo capturado ou - para stdin")
+    parser.add_argument("--serial", help="porta serial da UART de transmissão")
+    parser.add_argument("--baud", type=int, default=921600)
+    parser.add_argument("--quiet", action="store_true", help="mostra apenas o resumo")
+    args = parser.parse_args()
+
+    decoder = FrameDecoder()
+    source = open_source(args)
+    try:
+        while True:
+            chunk = source.read(4096)
+            if not chunk:
+                if args.serial:
+                    continue
+                break
+            for values in decoder.feed(chunk):
+                if not args.quiet:
+                    print(" ".join(str(v) for v in values))
+    except KeyboardInterrupt:
+        pass
+    print(decoder.summary(), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,138 @@
+#!/usr/bin/env python3
+"""Ferramenta do harness de gravação e replay (REPLAY_MODE em main.c).
+
+Amostra gravada: 8 bytes little-endian -> delta_us u32 | valor int32.
+
+Subcomandos:
+    extract  extrai os blocos REPLAY_BEGIN/REPLAY_DATA/REPLAY_END de um log
+             do console (REPLAY_MODE_RECORD) para um arquivo binário
+    header   gera replay_stream.h a partir do arquivo, para compilar o
+             firmware com REPLAY_MODE_REPLAY
+    info     mostra estatísticas do fluxo gravado
+    synth    sintetiza um fluxo (período fixo com jitter) sem gravar no alvo
+
+Uso:
+    python3 tools/replay_tool.py extract log_serial.txt -o fluxo.bin
+    python3 tools/replay_tool.py header fluxo.bin -o main/replay_stream.h
+    python3 tools/replay_tool.py info fluxo.bin
+    python3 tools/replay_tool.py synth --count 1024 --period-us 200000 -o fluxo.bin
+"""
+import argparse
+import random
+import statistics
+import struct
+import sys
+
+SAMPLE_FORMAT = "<Ii"
+SAMPLE_SIZE = struct.calcsize(SAMPLE_FORMAT)
+
+
+def read_samples(path):
+    data = open(path, "rb").read()
+    return [struct.unpack_from(SAMPLE_FORMAT, data, off)
+            for off in range(0, len(data) - SAMPLE_SIZE + 1, SAMPLE_SIZE)]
+
+
+def write_samples(path, samples):
+    with open(path, "wb") as out:
+        for delta_us, value in samples:
+            out.write(struct.pack(SAMPLE_FORMAT, delta_us, value))
+
+
+def cmd_extract(args):
+    samples = []
+    block = None
+    source = sys.stdin if args.input == "-" else open(args.input, errors="replace")
+    for line in source:
+        start = line.find("REPLAY_")
+        if start < 0:
+            continue
+        fields = line[start:].split()
+        if fields[0] == "REPLAY_BEGIN":
+            block = bytearray()
+        elif fields[0] == "REPLAY_DATA" and block is not None and len(fields) > 1:
+            block += bytes.fromhex(fields[1])
+        elif fields[0] == "REPLAY_END" and block is not None:
+            samples += [struct.unpack_from(SAMPLE_FORMAT, block, off)
+                        for off in range(0, len(block) - SAMPLE_SIZE + 1, SAMPLE_SIZE)]
+            block = None
+    write_samples(args.output, samples)
+    print("%d amostras gravadas em %s" % (len(samples), args.output), file=sys.stderr)
+
+
+def cmd_header(args):
+    samples = read_samples(args.input)
+    if args.limit:
+        samples = samples[:args.limit]
+    lines = [
+        "#pragma once",
+        "/* Gerado por tools/replay_tool.py a partir de %s: não editar. */" % args.input,
+        "#define REPLAY_STREAM_LEN %d" % len(samples),
+        "static const replay_sample_t replay_stream[REPLAY_STREAM_LEN] = {",
+    ]
+    lines += ["    { %uu, %d }," % (delta_us, value) for delta_us, value in samples]
+    lines.append("};")
+    with open(args.output, "w") as out:
+        out.write("\n".join(lines) + "\n")
+    print("%d amostras em %s" % (len(samples), args.output), file=sys.stderr)
+
+
+def cmd_info(args):
+    samples = read_samples(args.input)
+    if not samples:
+        print("arquivo vazio")
+        return
+    deltas = [d for d, _ in samples[1:]] or [0]
+    total_us = sum(deltas)
+    print("amostras: %d" % len(samples))
+    print("duração: %.3f s" % (total_us / 1e6))
+    print("intervalo: média %.1f us, desvio %.1f us, mín %d us, máx %d us" % (
+        statistics.mean(deltas), statistics.pstdev(deltas), min(deltas), max(deltas)))
+    if total_us:
+        print("taxa gravada: %.2f msg/s" % ((len(samples) - 1) * 1e6 / total_us))
+
+
+def cmd_synth(args):
+    rng = random.Random(args.seed)
+    samples = []
+    for i in range(args.count):
+        jitter = rng.uniform(-args.jitter_us, args.jitter_us) if args.jitter_us else 0
+        delta = 0 if i == 0 else max(0, int(args.period_us + jitter))
+        samples.append((delta, i + 1))
+    write_samples(args.output, samples)
+    print("%d amostras sintéticas em %s" % (len(samples), args.output), file=sys.stderr)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    p = sub.add_parser("extract")
+    p.add_argument("input", help="log do console ou - para stdin")
+    p.add_argument("-o", "--output", required=True)
+    p.set_defaults(func=cmd_extract)
+
+    p = sub.add_parser("header")
+    p.add_argument("input")
+    p.add_argument("-o", "--output", default="replay_stream.h")
+    p.add_argument("--limit", type=int, default=0, help="máximo de amostras (RAM/flash)")
+    p.set_defaults(func=cmd_header)
+
+    p = sub.add_parser("info")
+    p.add_argument("input")
+    p.set_defaults(func=cmd_info)
+
+    p = sub.add_parser("synth")
+    p.add_argument("--count", type=int, default=1024)
+    p.add_argument("--period-us", type=int, default=200000)
+    p.add_argument("--jitter-us", type=int, default=0)
+    p.add_argument("--seed", type=int, default=1)
+    p.add_argument("-o", "--output", required=True)
+    p.set_defaults(func=cmd_synth)
+
+    args = parser.parse_args()
+    args.func(args)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,149 @@
+#!/usr/bin/env python3
+"""Extrai os registros de status JSON do supervisor (STATUS_REPORT_JSON).
+
+Cada registro é uma linha {"rec":"status","v":1,...} no log do console,
+possivelmente precedida de prefixos do monitor serial. Os contadores são
+acumulados desde o boot; o objeto "d" traz os deltas desde o registro
+anterior e "dt_ms" o intervalo, então taxas saem de d / dt_ms mesmo com o
+firmware emitindo só em mudança ou no heartbeat lento.
+
+Saídas:
+    summary  resumo com taxas médias e a linha do tempo de estados (padrão)
+    csv      uma linha por registro, métricas achatadas (lanes.urgente.drop, ...)
+    prom     último registro no formato de exposição de texto do Prometheus
+
+Uso:
+    python3 tools/status_parser.py console.log
+    idf.py monitor | tee console.log | python3 tools/status_parser.py - --format csv
+    python3 tools/status_parser.py console.log --format prom > status.prom
+"""
+import argparse
+import csv
+import json
+import sys
+
+MARKER = '{"rec":"status"'
+SUPPORTED_VERSION = 1
+
+
+def parse_records(lines):
+    """Gera (número da linha, registro) para cada registro válido."""
+    for lineno, line in enumerate(lines, 1):
+        start = line.find(MARKER)
+        if start < 0:
+            continue
+        try:
+            record = json.loads(line[start:].strip())
+        except json.JSONDecodeError as exc:
+            print(f"linha {lineno}: registro truncado ({exc.msg})", file=sys.stderr)
+            continue
+        if record.get("v") != SUPPORTED_VERSION:
+            print(f"linha {lineno}: versão {record.get('v')} não suportada", file=sys.stderr)
+            continue
+        yield lineno, record
+
+
+def flatten(value, prefix=""):
+    """Achata objetos e listas em {"rx.p99_us": ..., "lanes.urgente.drop": ...}."""
+    out = {}
+    if isinstance(value, dict):
+        for key, item in value.items():
+            name = key if not prefix else f"{prefix}.{key}"
+            out.update(flatten(item, name))
+    elif isinstance(value, list):
+        # Listas de objetos com nome viram lanes.urgente.drop em vez de índices
+        for index, item in enumerate(value):
+            label = item.get("name", index) if isinstance(item, dict) else index
+            out.update(flatten(item, f"{prefix}.{label}"))
+    elif isinstance(value, bool):
+        out[prefix] = int(value)
+    else:
+        out[prefix] = value
+    return out
+
+
+def summarize(records):
+    if not records:
+        return "Nenhum registro de status encontrado"
+    first, last = records[0], records[-1]
+    span_ms = sum(r.get("dt_ms", 0) for r in records[1:])
+    totals = {}
+    for record in records[1:]:
+        for key, value in record.get("d", {}).items():
+            totals[key] = totals.get(key, 0) + value
+
+    out = [f"Registros: {len(records)} (seq {first['seq']}..{last['seq']}, "
+           f"{span_ms / 1000:.1f} s cobertos)"]
+    missing = last["seq"] - first["seq"] + 1 - len(records)
+    if missing > 0:
+        out.append(f"Registros ausentes no log: {missing}")
+    reasons = {}
+    for record in records:
+        reasons[record["why"]] = reasons.get(record["why"], 0) + 1
+    out.append("Motivos: " + ", ".join(f"{k}={v}" for k, v in sorted(reasons.items())))
+    if span_ms > 0:
+        rates = ", ".join(f"{key}={value * 1000 / span_ms:.2f}/s" for key, value in sorted(totals.items()))
+        out.append(f"Taxas médias: {rates}")
+
+    out.append("Linha do tempo de estados:")
+    prev = None
+    for record in records:
+        state = (record["gen"], record["rcv"])
+        if state != prev:
+            out.append(f"  t={record['t_ms'] / 1000:10.3f} s  gerador={state[0]:<6} receptor={state[1]}")
+            prev = state
+
+    rx = last["rx"]
+    out.append(f"Último: latência p50={rx['p50_us']} p99={rx['p99_us']} max={rx['max_us']} us, "
+               f"CRC={rx['crc_err']}, lacunas={rx['gaps']}, heap={last['heap'][0]} (mín {last['heap'][1]})")
+    for lane in last["lanes"]:
+        out.append(f"  {lane['name']:<8} env={lane['sent']} rec={lane['recv']} perdas={lane['drop']} "
+                   f"pico={lane['peak']} p99={lane['p99_us']} us")
+    for incident in last["inc"]:
+        state = "ABERTO" if incident["open"] else "fechado"
+        out.append(f"  incidentes {incident['name']}: {incident['count']} ({state}), "
+                   f"MTTR={incident['mttr_ms']} ms, MTBF={incident['mtbf_ms']} ms")
+    return "\n".join(out)
+
+
+def write_csv(records, stream):
+    rows = [flatten(record) for _, record in records]
+    columns = []
+    for row in rows:
+        for key in row:
+            if key not in columns:
+                columns.append(key)
+    writer = csv.DictWriter(stream, fieldnames=columns)
+    writer.writeheader()
+    writer.writerows(rows)
+
+
+def write_prom(record, stream):
+    for key, value in flatten(record).items():
+        if not isinstance(value, (int, float)) or key in ("v", "seq", "dt_ms") or key.startswith("d."):
+            continue
+        name = "sup_" + key.replace(".", "_").lower()
+        stream.write(f"{name} {value}\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("input", nargs="?", default="-", help="log do console ou - para stdin")
+    parser.add_argument("--format", choices=("summary", "csv", "prom"), default="summary")
+    args = parser.parse_args()
+
+    source = sys.stdin if args.input == "-" else open(args.input, encoding="utf-8", errors="replace")
+    with source:
+        records = list(parse_records(source))
+
+    if args.format == "csv":
+        write_csv(records, sys.stdout)
+    elif args.format == "prom":
+        if records:
+            write_prom(records[-1][1], sys.stdout)
+    else:
+        print(summarize([record for _, record in records]))
+
+
+if __name__ == "__main__":
+    main()
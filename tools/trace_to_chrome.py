@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+"""Converte janelas do gravador de trace (TRACE_RECORDER_ENABLED) em JSON
+do Chrome Trace Event Format, que abre em chrome://tracing e no Perfetto.
+
+O firmware despeja cada janela no console entre TRACE_BEGIN e TRACE_END:
+
+    TRACE_BEGIN <núcleos>
+    TRACE_TASK <id> <nome>
+    TRACE_OBJ <id> <nome>
+    TRACE_DATA <núcleo> <hex de eventos de 8 bytes: ts_us u32 | tipo u8 | - u8 | arg u16>
+    TRACE_STATS <núcleo> <eventos> <descartados> <ciclos de gravação>
+    TRACE_END
+
+Linhas de log intercaladas são ignoradas. Cada núcleo vira uma thread;
+o tempo em que uma tarefa roda vira um bloco, e filas/event groups viram
+eventos instantâneos.
+
+Uso:
+    python3 tools/trace_to_chrome.py log_serial.txt -o trace.json
+"""
+import argparse
+import json
+import struct
+import sys
+
+EVENT_FORMAT = "<IBBH"
+EVENT_SIZE = struct.calcsize(EVENT_FORMAT)
+
+# Devem coincidir com TRACE_EVT_* em trace_hooks.h
+TASK_IN = 1
+TASK_OUT = 2
+OBJECT_EVENTS = {
+    3: "send",
+    4: "send_isr",
+    5: "receive",
+    6: "block_send",
+    7: "block_receive",
+}
+GROUP_SET_BITS = 8
+UNKNOWN_ID = 0xFFFF
+
+
+class Window:
+    def __init__(self, cores):
+        self.cores = cores
+        self.tasks = {}
+        self.objects = {}
+        self.data = {core: bytearray() for core in range(cores)}
+        self.stats = {}
+
+
+def parse_windows(lines):
+    window = None
+    for line in lines:
+        # Remove prefixos de log (ex.: timestamps do monitor serial)
+        start = line.find("TRACE_")
+        if start < 0:
+            continue
+        fields = line[start:].strip().split(" ", 2)
+        tag = fields[0]
+        if tag == "TRACE_BEGIN":
+            window = Window(int(fields[1]))
+        elif window is None:
+            continue
+        elif tag == "TRACE_TASK":
+            window.tasks[int(fields[1])] = fields[2] if len(fields) > 2 else "?"
+        elif tag == "TRACE_OBJ":
+            window.objects[int(fields[1])] = fields[2] if len(fields) > 2 else "?"
+        elif tag == "TRACE_DATA":
+            window.data.setdefault(int(fields[1]), bytearray()).extend(bytes.fromhex(fields[2]))
+        elif tag == "TRACE_STATS":
+            count, dropped, cycles = (int(v) for v in fields[2].split())
+            window.stats[int(fields[1])] = (count, dropped, cycles)
+        elif tag == "TRACE_END":
+            yield window
+            window = None
+
+
+def unwrap(timestamps):
+    """Desdobra timestamps de 32 bits em us monotônicos."""
+    offset = 0
+    prev = None
+    for ts in timestamps:
+        if prev is not None and ts < prev and prev - ts > 0x80000000:
+            offset += 1 << 32
+        prev = ts
+        yield ts + offset
+
+
+def convert(windows):
+    events = []
+    for index, window in enumerate(windows):
+        pid = index
+        events.append({"ph": "M", "name": "process_name", "pid": pid,
+                       "args": {"name": "Janela %d" % index}})
+        for core, raw in sorted(window.data.items()):
+            events.append({"ph": "M", "name": "thread_name", "pid": pid, "tid": core,
+                           "args": {"name": "Núcleo %d" % core}})
+            decoded = [struct.unpack_from(EVENT_FORMAT, raw, off)
+                       for off in range(0, len(raw) - EVENT_SIZE + 1, EVENT_SIZE)]
+            running = None
+            for (ts, kind, _, arg), t in zip(decoded, unwrap(e[0] for e in decoded)):
+                if kind == TASK_IN:
+                    name = window.tasks.get(arg, "tarefa %d" % arg)
+                    events.append({"ph": "B", "name": name, "pid": pid, "tid": core, "ts": t})
+                    running = name
+                elif kind == TASK_OUT:
+                    if running is not None:
+                        events.append({"ph": "E", "name": running, "pid": pid, "tid": core, "ts": t})
+                        running = None
+                elif kind in OBJECT_EVENTS:
+                    obj = window.objects.get(arg, "objeto %d" % arg if arg != UNKNOWN_ID else "?")
+                    events.append({"ph": "i", "s": "t", "name": "%s %s" % (OBJECT_EVENTS[kind], obj),
+                                   "pid": pid, "tid": core, "ts": t, "cat": "queue"})
+                elif kind == GROUP_SET_BITS:
+                    events.append({"ph": "i", "s": "t", "name": "set_bits 0x%04x" % arg,
+                                   "pid": pid, "tid": core, "ts": t, "cat": "event_group"})
+            if running is not None and decoded:
+                last = list(unwrap(e[0] for e in decoded))[-1]
+                events.append({"ph": "E", "name": running, "pid": pid, "tid": core, "ts": last})
+
+        for core, (count, dropped, cycles) in sorted(window.stats.items()):
+            per_event = cycles / count if count else 0.0
+            print("janela %d núcleo %d: %d eventos, %d descartados, %.1f ciclos/evento"
+                  % (index, core, count, dropped, per_event), file=sys.stderr)
+    return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("input", nargs="?", default="-", help="log do console ou - para stdin")
+    parser.add_argument("-o", "--output", default="-", help="arquivo JSON de saída")
+    args = parser.parse_args()
+
+    source = sys.stdin if args.input == "-" else open(args.input, errors="replace")
+    trace = convert(list(parse_windows(source)))
+    out = sys.stdout if args.output == "-" else open(args.output, "w")
+    json.dump(trace, out)
+    out.write("\n")
+
+
+if __name__ == "__main__":
+    main()
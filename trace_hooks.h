@@ -0,0 +1,103 @@
+#pragma once
+/* Ganchos de trace do FreeRTOS para o gravador de timeline de main.c.
+ *
+ * Este header precisa ser incluído à força em todo o build (o kernel
+ * expande os macros trace* em tasks.c, queue.c e event_groups.c), por
+ * exemplo no CMakeLists.txt do projeto:
+ *
+ *   idf_build_set_property(COMPILE_OPTIONS "-include"
+ *                          "${CMAKE_SOURCE_DIR}/main/trace_hooks.h" APPEND)
+ *
+ * Ele não inclui headers do FreeRTOS: os ganchos recebem ponteiros opacos.
+ * Com TRACE_RECORDER_ENABLED e SCHED_STATS_ENABLED em 0 nenhum macro é
+ * definido e o kernel usa as versões vazias padrão.
+ *
+ * SCHED_STATS_ENABLED liga os contadores de trocas de contexto por tarefa
+ * (voluntárias = a tarefa anunciou que ia bloquear antes de sair) e a
+ * latência entre ficar pronta e voltar a rodar. */
+
+#ifndef TRACE_RECORDER_ENABLED
+#define TRACE_RECORDER_ENABLED  0
+#endif
+
+#ifndef SCHED_STATS_ENABLED
+#define SCHED_STATS_ENABLED     0
+#endif
+
+/* Tipos de evento gravados no ring (compartilhados com tools/trace_to_chrome.py) */
+#define TRACE_EVT_TASK_IN           1   // arg = id da tarefa
+#define TRACE_EVT_TASK_OUT          2   // arg = id da tarefa
+#define TRACE_EVT_QUEUE_SEND        3   // arg = id do objeto
+#define TRACE_EVT_QUEUE_SEND_ISR    4
+#define TRACE_EVT_QUEUE_RECEIVE     5
+#define TRACE_EVT_QUEUE_BLOCK_SEND  6
+#define TRACE_EVT_QUEUE_BLOCK_RECV  7
+#define TRACE_EVT_GROUP_SET_BITS    8   // arg = bits (16 baixos)
+
+/* Os protótipos ficam fora dos .S: o -include do build vale também para o
+ * assembly do port, e lá só os macros podem aparecer. */
+#if TRACE_RECORDER_ENABLED
+#ifndef __ASSEMBLER__
+void trace_rec_task_switched_in(void);
+void trace_rec_task_switched_out(void);
+void trace_rec_object_event(unsigned int type, void *object);
+void trace_rec_group_set_bits(void *group, unsigned int bits);
+#endif
+#define TRACE_REC_HOOK(call)        call
+#else
+#define TRACE_REC_HOOK(call)        do { } while (0)
+#endif
+
+#if SCHED_STATS_ENABLED
+#ifndef __ASSEMBLER__
+void sched_rec_switched_in(void);
+void sched_rec_switched_out(void);
+void sched_rec_blocking(void);
+void sched_rec_ready(void *task);
+#endif
+#define SCHED_STATS_HOOK(call)      call
+#else
+#define SCHED_STATS_HOOK(call)      do { } while (0)
+#endif
+
+/* Ganchos compartilhados pelos dois consumidores */
+#if TRACE_RECORDER_ENABLED || SCHED_STATS_ENABLED
+#define traceTASK_SWITCHED_IN() do { \
+    TRACE_REC_HOOK(trace_rec_task_switched_in()); \
+    SCHED_STATS_HOOK(sched_rec_switched_in()); \
+} while (0)
+#define traceTASK_SWITCHED_OUT() do { \
+    TRACE_REC_HOOK(trace_rec_task_switched_out()); \
+    SCHED_STATS_HOOK(sched_rec_switched_out()); \
+} while (0)
+#define traceBLOCKING_ON_QUEUE_SEND(pxQueue) do { \
+    TRACE_REC_HOOK(trace_rec_object_event(TRACE_EVT_QUEUE_BLOCK_SEND, (void *)(pxQueue))); \
+    SCHED_STATS_HOOK(sched_rec_blocking()); \
+} while (0)
+#define traceBLOCKING_ON_QUEUE_RECEIVE(pxQueue) do { \
+    TRACE_REC_HOOK(trace_rec_object_event(TRACE_EVT_QUEUE_BLOCK_RECV, (void *)(pxQueue))); \
+    SCHED_STATS_HOOK(sched_rec_blocking()); \
+} while (0)
+#endif
+
+#if TRACE_RECORDER_ENABLED
+#define traceQUEUE_SEND(pxQueue)                    trace_rec_object_event(TRACE_EVT_QUEUE_SEND, (void *)(pxQueue))
+#define traceQUEUE_SEND_FROM_ISR(pxQueue)           trace_rec_object_event(TRACE_EVT_QUEUE_SEND_ISR, (void *)(pxQueue))
+#define traceQUEUE_RECEIVE(pxQueue)                 trace_rec_object_event(TRACE_EVT_QUEUE_RECEIVE, (void *)(pxQueue))
+#define traceEVENT_GROUP_SET_BITS(xEventGroup, uxBitsToSet) \
+    trace_rec_group_set_bits((void *)(xEventGroup), (unsigned int)(uxBitsToSet))
+#endif
+
+/* Demais pontos em que a tarefa atual vai bloquear. Variádicos: a lista de
+ * argumentos muda entre versões do kernel e não é usada. */
+#if SCHED_STATS_ENABLED
+#define traceTASK_DELAY(...)                        sched_rec_blocking()
+#define traceTASK_DELAY_UNTIL(...)                  sched_rec_blocking()
+#define traceTASK_NOTIFY_TAKE_BLOCK(...)            sched_rec_blocking()
+#define traceTASK_NOTIFY_WAIT_BLOCK(...)            sched_rec_blocking()
+#define traceEVENT_GROUP_WAIT_BITS_BLOCK(...)       sched_rec_blocking()
+#define traceEVENT_GROUP_SYNC_BLOCK(...)            sched_rec_blocking()
+#define traceBLOCKING_ON_STREAM_BUFFER_SEND(...)    sched_rec_blocking()
+#define traceBLOCKING_ON_STREAM_BUFFER_RECEIVE(...) sched_rec_blocking()
+#define traceMOVED_TASK_TO_READY_STATE(pxTCB)       sched_rec_ready((void *)(pxTCB))
+#endif